@@ -0,0 +1,26 @@
+#ifndef __BATCH_CONTROLLER_H__
+#define __BATCH_CONTROLLER_H__
+
+#include <glib.h>
+
+// Decisions taken by the batch controller during the current tracking session.
+typedef struct batch_controller_stats {
+	int grows;
+	int shrinks;
+	int reconnect_resets;
+	int held_for_phone;
+	int flushes;
+} batch_controller_stats_s;
+
+void batch_controller_reset();
+void batch_controller_set_ceiling(int ceiling);
+// Fixed batch size while the service degrades (low battery or memory), 0 gives control back.
+void batch_controller_set_override(int size);
+int  batch_controller_get_size();
+void batch_controller_on_phone_activity();
+void batch_controller_on_send_result(gboolean success);
+void batch_controller_on_reconnect();
+const batch_controller_stats_s *batch_controller_get_stats();
+void batch_controller_log_stats();
+
+#endif
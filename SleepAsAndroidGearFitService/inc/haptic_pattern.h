@@ -0,0 +1,26 @@
+#ifndef __HAPTIC_PATTERN_H__
+#define __HAPTIC_PATTERN_H__
+
+#include <glib.h>
+
+typedef enum {
+	// Crescendo that keeps going until stopped.
+	HAPTIC_PATTERN_ALARM,
+	// A given number of pulses.
+	HAPTIC_PATTERN_HINT,
+} haptic_pattern_e;
+
+// Plays vibration patterns, each pulse is one wakeup that starts a vibration of the whole pulse length.
+// Only one pattern plays at a time: an alarm cuts a hint short, hints are refused while an alarm plays
+// and an alarm requested while one plays leaves it at its current step.
+// The CPU lock is held only while something plays. The vibrator is open while something plays,
+// or for as long as the engine is kept warm.
+// requested_at (ecore_time_get) is when the request reached the watch, the time to the first pulse is kept in a histogram.
+gboolean haptic_pattern_play(haptic_pattern_e pattern, int repeats, double delay_sec, double requested_at);
+void haptic_pattern_stop(haptic_pattern_e pattern);
+// While warm the vibrator stays open between patterns, so the first pulse needs no device open.
+void haptic_pattern_set_warm(gboolean warm);
+void haptic_pattern_reset_stats();
+void haptic_pattern_log_stats();
+
+#endif
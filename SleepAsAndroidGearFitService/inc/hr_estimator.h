@@ -0,0 +1,28 @@
+#ifndef __HR_ESTIMATOR_H__
+#define __HR_ESTIMATOR_H__
+
+#include <glib.h>
+
+typedef enum {
+	// Keep measuring.
+	HR_ESTIMATE_PENDING,
+	// Samples agree, the estimate can be reported and the sensor stopped.
+	HR_ESTIMATE_CONVERGED,
+	// Gave up, the estimate is filled only if there were enough samples to say anything.
+	HR_ESTIMATE_GAVE_UP,
+} hr_estimate_status_e;
+
+typedef struct hr_estimate {
+	float bpm;
+	// 0..1, how tightly the samples agree around the median.
+	float confidence;
+	int samples;
+} hr_estimate_s;
+
+// Streaming heart rate estimate from HRM samples: running median and median absolute deviation
+// over the latest samples, finished as soon as they agree within a tolerance.
+void hr_estimator_reset();
+hr_estimate_status_e hr_estimator_add(float bpm, hr_estimate_s *estimate);
+hr_estimate_status_e hr_estimator_give_up(hr_estimate_s *estimate);
+
+#endif
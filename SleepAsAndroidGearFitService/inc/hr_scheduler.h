@@ -0,0 +1,14 @@
+#ifndef __HR_SCHEDULER_H__
+#define __HR_SCHEDULER_H__
+
+#include <glib.h>
+
+// Decides at which epochs an HR measurement is started. Movement shortens the pause between measurements,
+// long still periods stretch it, and the sensor-on time of a night is capped by a budget.
+void hr_scheduler_reset(int epoch_sec);
+// Called once per epoch with the epoch's max_sum, returns TRUE when a measurement should start now.
+gboolean hr_scheduler_on_epoch(float max_sum);
+void hr_scheduler_on_measurement_done(double sensor_on_sec);
+void hr_scheduler_log_stats();
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef __POWER_LOCK_H__
+#define __POWER_LOCK_H__
+
+// Reference counted POWER_LOCK_CPU which also keeps track of how long the lock was held.
+void   power_lock_cpu_acquire();
+void   power_lock_cpu_release();
+double power_lock_cpu_held_sec();
+void   power_lock_reset_stats();
+void   power_lock_log_stats();
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __PPG_HRV_H__
+#define __PPG_HRV_H__
+
+#include <glib.h>
+
+// Beat to beat summary of one HR window.
+typedef struct ppg_hrv_summary {
+	float mean_rr_ms;
+	float sdnn_ms;
+	float rmssd_ms;
+	// Accepted RR intervals the summary is based on.
+	int rr_count;
+} ppg_hrv_summary_s;
+
+// Streaming RR extraction from the green LED PPG: band-pass filter, peak detection and artifact rejection.
+// Only running sums are kept, nothing of the raw signal is stored.
+void ppg_hrv_reset(float sample_rate_hz);
+void ppg_hrv_add(unsigned long long timestamp_us, float value);
+// Clean RR intervals collected so far in this window.
+int ppg_hrv_rr_count();
+// Returns FALSE when the window did not give enough clean beats for a summary.
+gboolean ppg_hrv_summary(ppg_hrv_summary_s *summary);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <Ecore.h>
+
+// All service timers live on one hierarchical timer wheel driven by a single Ecore timer.
+// Callbacks follow Ecore_Task_Cb rules: return ECORE_CALLBACK_RENEW to repeat, ECORE_CALLBACK_CANCEL to stop.
+typedef struct scheduler_timer scheduler_timer_s;
+
+// Slack is how late (in seconds) the timer may fire so it can share a wakeup with another timer.
+scheduler_timer_s *scheduler_timer_add(double interval, double slack, Ecore_Task_Cb cb, const void *data);
+void scheduler_timer_del(scheduler_timer_s *timer);
+void scheduler_timer_delay(scheduler_timer_s *timer, double add);
+
+void scheduler_reset_stats();
+void scheduler_log_stats();
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef __SHARED_STATE_H__
+#define __SHARED_STATE_H__
+
+#include <stdint.h>
+
+// State record the service publishes for the watchface in the package data directory.
+// The same header lives in both projects, keep them identical and bump the version on any layout change.
+#define SHARED_STATE_FILE "sleep_state.bin"
+#define SHARED_STATE_VERSION 4
+// Epochs kept in the ring, a bit over 10 minutes.
+#define SHARED_STATE_RING 64
+// HR readings kept, over an hour even at the shortest measurement interval.
+#define SHARED_STATE_HR_RING 32
+
+// Answer of the service to a start request.
+typedef enum {
+	SHARED_START_NONE,
+	SHARED_START_TRACKING,
+	SHARED_START_REJECTED,
+} shared_start_result_e;
+
+typedef struct shared_epoch {
+	float max_sum;
+	float avg_sum;
+} shared_epoch_s;
+
+typedef struct shared_hr {
+	// Milliseconds since epoch at which the reading was taken.
+	int64_t at;
+	float bpm;
+	float confidence;
+} shared_hr_s;
+
+typedef struct shared_state {
+	uint32_t version;
+	// Odd while the service is writing. Readers copy the record and retry if seq changed meanwhile.
+	volatile uint32_t seq;
+	// Seconds since epoch of the last change.
+	int64_t updated_at;
+	int64_t paused_till;
+	int64_t last_epoch_at;
+	float last_epoch_max_sum;
+	float last_epoch_avg_sum;
+	// Epochs of the current session so far, epoch n sits in ring[n % SHARED_STATE_RING].
+	uint32_t epoch_count;
+	uint8_t tracking;
+	uint8_t alarm_active;
+	uint8_t link_connected;
+	// shared_start_result_e of the latest start request.
+	uint8_t start_result;
+	// Start requests answered so far, a requester waits for it to move past the value it saw.
+	uint32_t start_answers;
+	shared_epoch_s ring[SHARED_STATE_RING];
+	// HR readings of the current session so far, reading n sits in hr_ring[n % SHARED_STATE_HR_RING].
+	uint32_t hr_count;
+	uint32_t reserved_hr;
+	shared_hr_s hr_ring[SHARED_STATE_HR_RING];
+} shared_state_s;
+
+#endif
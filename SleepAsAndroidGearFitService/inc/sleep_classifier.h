@@ -0,0 +1,24 @@
+#ifndef __SLEEP_CLASSIFIER_H__
+#define __SLEEP_CLASSIFIER_H__
+
+#include <glib.h>
+
+// Stage codes as sent to the phone.
+typedef enum {
+	SLEEP_STAGE_UNKNOWN = 0,
+	SLEEP_STAGE_WAKE = 1,
+	SLEEP_STAGE_LIGHT = 2,
+	SLEEP_STAGE_DEEP = 3,
+} sleep_stage_e;
+
+// Incremental Cole-Kripke style sleep/wake scoring over one minute windows built from the epochs,
+// with still stretches of sleep marked deep. Fixed time and memory per epoch.
+void sleep_classifier_reset(int epoch_sec);
+// Feeds one epoch. Returns TRUE when a minute got scored, the scoring lags a few minutes behind
+// because the window looks ahead. minute is the index of the scored minute since the reset.
+gboolean sleep_classifier_add_epoch(float max_sum, int *minute, sleep_stage_e *stage);
+// Stage of the latest scored minute.
+sleep_stage_e sleep_classifier_current();
+void sleep_classifier_log_stats();
+
+#endif
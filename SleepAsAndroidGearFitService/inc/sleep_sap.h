@@ -9,12 +9,20 @@
 #include <dlog.h>
 
 typedef  void (*data_received_cb)(unsigned int payload_length, void *buffer);
+typedef  void (*connection_changed_cb)(gboolean connected);
 
-void     initialize_sap(data_received_cb data_received);
+typedef enum {
+	SEND_RESULT_OK,
+	SEND_RESULT_NO_CONNECTION,
+	SEND_RESULT_FAILED,
+} send_result_e;
+
+void     initialize_sap(data_received_cb data_received, connection_changed_cb connection_changed);
 void	 terminate_sap();
 gboolean find_peers();
 gboolean request_service_connection(void);
 gboolean terminate_service_connection(void);
-gboolean send_data(char *message);
+gboolean is_connected();
+send_result_e send_data(char *message);
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef __SMART_ALARM_H__
+#define __SMART_ALARM_H__
+
+#include "sleep_classifier.h"
+
+#include <glib.h>
+
+typedef enum {
+	SMART_ALARM_NONE,
+	// Scored awake.
+	SMART_ALARM_WAKE,
+	// Scored light sleep, high sensitivity only.
+	SMART_ALARM_LIGHT,
+	// An epoch with enough movement.
+	SMART_ALARM_MOVEMENT,
+	// Latest time of the window reached.
+	SMART_ALARM_DEADLINE,
+} smart_alarm_trigger_e;
+
+// Smart alarm window handed over by the phone, evaluated on the watch every epoch so the wakeup
+// does not depend on batches reaching the phone or the link being up.
+// Times are milliseconds since epoch, sensitivity 0 (low) to 2 (high).
+gboolean smart_alarm_set(gint64 earliest, gint64 latest, int sensitivity);
+void smart_alarm_clear();
+gboolean smart_alarm_is_armed();
+gint64 smart_alarm_latest();
+// stage is the latest scored minute and stage_at the time that minute started.
+smart_alarm_trigger_e smart_alarm_on_epoch(gint64 now, float max_sum, sleep_stage_e stage, gint64 stage_at);
+const char *smart_alarm_trigger_name(smart_alarm_trigger_e trigger);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef __STATE_PAGE_H__
+#define __STATE_PAGE_H__
+
+#include <glib.h>
+
+// Writer side of the shared state record (shared_state.h).
+// State transitions notify the watchface, epoch statistics are updated silently and read on its own schedule.
+void state_page_open();
+void state_page_close();
+void state_page_set_tracking(gboolean tracking);
+// Answers a start request, also when it was a duplicate or failed.
+void state_page_answer_start(gboolean started);
+void state_page_set_paused_till(gint64 paused_till);
+void state_page_set_alarm_active(gboolean active);
+void state_page_set_link(gboolean connected);
+void state_page_set_last_epoch(float max_sum, float avg_sum);
+void state_page_add_hr(gint64 at, float bpm, float confidence);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef __UI_CHANNEL_H__
+#define __UI_CHANNEL_H__
+
+#include <app.h>
+
+#define WATCHFACE_APP_ID "com.urbandroid.sleep.gearfit.watchface"
+// Message ports kept open by the service and the watchface for the lifetime of the process.
+#define SERVICE_PORT "sleep_service_port"
+#define WATCHFACE_PORT "sleep_watchface_port"
+
+// Keys of the bundle / app_control extras. app_action carries the command string as before.
+#define KEY_ACTION "app_action"
+#define KEY_TYPE "type"
+#define KEY_SENT_AT "sent_at"
+
+typedef enum {
+	// One-off events, always delivered.
+	UI_MESSAGE_EVENT,
+	// State updates, only the latest value matters and repeats are coalesced.
+	// Tracking and pause state are read from the state page, only the alarm still has to bring the watchface up.
+	UI_MESSAGE_ALARM,
+	UI_MESSAGE_TYPE_COUNT,
+} ui_message_type_e;
+
+typedef void (*ui_action_cb)(const char *action);
+
+void ui_channel_init(ui_action_cb action_received);
+void ui_channel_shutdown();
+void ui_channel_send(ui_message_type_e type, const char *command);
+void ui_channel_note_latency(const char *via, const char *sent_at);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef __WAKE_ALARM_H__
+#define __WAKE_ALARM_H__
+
+#include <app.h>
+#include <glib.h>
+
+// Wall clock alarms that wake the device from suspend and are delivered to service_app_control.
+// Scheduler timers stand still while the CPU sleeps, deadlines which must hold then are set here as well.
+typedef enum {
+	WAKE_ALARM_SMART_ALARM,
+	WAKE_ALARM_PAUSE_REARM,
+	WAKE_ALARM_COUNT,
+} wake_alarm_e;
+
+// Arms or moves the alarm, `at` is milliseconds since epoch. The alarm service works in whole seconds.
+gboolean wake_alarm_set(wake_alarm_e alarm, gint64 at);
+void wake_alarm_cancel(wake_alarm_e alarm);
+// Returns TRUE and which alarm it was when the app control is one of our wakeups. The alarm is no longer armed.
+gboolean wake_alarm_from_app_control(app_control_h app_control, wake_alarm_e *alarm);
+
+#endif
@@ -0,0 +1,109 @@
+#include "batch_controller.h"
+
+#include "common.h"
+
+#include <dlog.h>
+#include <string.h>
+
+// Smallest batch we ever fall back to. One epoch means every epoch is sent right away.
+#define MIN_BATCH_SIZE 1
+// How many clean flushes in a row we need before we dare to double the batch.
+#define GROW_AFTER_SUCCESSES 3
+
+// Batch size requested by the phone (BatchSize;N). This is the latency ceiling, only an override goes above it.
+static int ceiling = 1;
+// Batch size forced by a degradation mode, 0 when none.
+static int override = 0;
+// Batch size currently used.
+static int current = MIN_BATCH_SIZE;
+// Successful flushes since the last change of the batch size.
+static int success_streak = 0;
+// Did the phone talk to us since the last flush? If so, it is not idle and we do not grow.
+static gboolean phone_active = FALSE;
+
+static batch_controller_stats_s stats = { 0 };
+
+static void set_current(int size) {
+	if (override > 0) {
+		size = override;
+	} else if (size > ceiling) {
+		size = ceiling;
+	}
+	if (size < MIN_BATCH_SIZE) {
+		size = MIN_BATCH_SIZE;
+	}
+	current = size;
+	success_streak = 0;
+}
+
+void batch_controller_reset() {
+	memset(&stats, 0, sizeof(stats));
+	phone_active = FALSE;
+	set_current(MIN_BATCH_SIZE);
+}
+
+void batch_controller_set_ceiling(int size) {
+	ceiling = size < MIN_BATCH_SIZE ? MIN_BATCH_SIZE : size;
+	if (current > ceiling) {
+		set_current(ceiling);
+	}
+	dlog_print(DLOG_INFO, TAG, "Batch ceiling: %d, current batch: %d", ceiling, current);
+}
+
+void batch_controller_set_override(int size) {
+	override = size > 0 ? size : 0;
+	set_current(override > 0 ? override : MIN_BATCH_SIZE);
+	dlog_print(DLOG_INFO, TAG, "Batch override: %d, current batch: %d", override, current);
+}
+
+int batch_controller_get_size() {
+	return current;
+}
+
+void batch_controller_on_phone_activity() {
+	phone_active = TRUE;
+}
+
+void batch_controller_on_send_result(gboolean success) {
+	stats.flushes++;
+
+	if (!success) {
+		if (current > MIN_BATCH_SIZE) {
+			stats.shrinks++;
+		}
+		set_current(current / 2);
+		dlog_print(DLOG_INFO, TAG, "Batch send failed, shrinking batch to %d", current);
+		phone_active = FALSE;
+		return;
+	}
+
+	if (phone_active) {
+		// Phone is busy with us (pause, alarm, settings..), keep the batch until it calms down.
+		stats.held_for_phone++;
+		success_streak = 0;
+		phone_active = FALSE;
+		return;
+	}
+
+	success_streak++;
+	if (success_streak >= GROW_AFTER_SUCCESSES && current < ceiling && override == 0) {
+		stats.grows++;
+		set_current(current * 2);
+		dlog_print(DLOG_INFO, TAG, "Link healthy, growing batch to %d", current);
+	}
+}
+
+void batch_controller_on_reconnect() {
+	stats.reconnect_resets++;
+	set_current(MIN_BATCH_SIZE);
+	dlog_print(DLOG_INFO, TAG, "Reconnected, batch back to %d", current);
+}
+
+const batch_controller_stats_s *batch_controller_get_stats() {
+	return &stats;
+}
+
+void batch_controller_log_stats() {
+	dlog_print(DLOG_INFO, TAG, "Batch stats: size %d/%d, flushes %d, grows %d, shrinks %d, reconnect resets %d, held for phone %d",
+			current, ceiling, stats.flushes, stats.grows, stats.shrinks, stats.reconnect_resets, stats.held_for_phone);
+}
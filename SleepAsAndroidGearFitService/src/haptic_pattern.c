@@ -0,0 +1,239 @@
+#include "haptic_pattern.h"
+
+#include "common.h"
+#include "power_lock.h"
+#include "scheduler.h"
+
+#include <device/haptic.h>
+#include <dlog.h>
+#include <Ecore.h>
+#include <string.h>
+
+// Delays shorter than this play right away, the scheduler would round them up to its tick.
+#define IMMEDIATE_SEC 0.01
+
+// Pattern steps: pulses of on_ms at feedback (0-100), one every period_ms, count times (-1 = forever).
+typedef struct haptic_step {
+	int on_ms;
+	int feedback;
+	int period_ms;
+	int count;
+} haptic_step_s;
+
+// Gentle first, then longer pulses with fewer wakeups per minute than the old 1 s every 2 s.
+static const haptic_step_s alarm_steps[] = {
+	{ 500, 40, 2000, 10 },
+	{ 1000, 70, 2000, 10 },
+	{ 2000, 100, 3000, -1 },
+};
+
+static const char *pattern_names[] = { "alarm", "hint" };
+
+// Upper bounds (ms) of the request to first pulse latency buckets, the last bucket takes the rest.
+static const int latency_bounds[] = { 10, 50, 100, 250, 500, 1000 };
+#define LATENCY_BUCKETS (sizeof(latency_bounds) / sizeof(latency_bounds[0]) + 1)
+static int latency_histogram[LATENCY_BUCKETS];
+static int cold_opens = 0;
+
+static struct {
+	gboolean playing;
+	haptic_pattern_e pattern;
+	const haptic_step_s *steps;
+	int step_count;
+	int step;
+	// Pulses left in the current step, -1 for forever.
+	int left;
+	haptic_step_s hint_step;
+	scheduler_timer_s *timer;
+	double started_at;
+	int wakeups;
+	// When the first pulse is due, 0 once it played.
+	double first_pulse_due;
+} playback;
+
+static haptic_device_h device = NULL;
+static haptic_effect_h effect = NULL;
+static gboolean warm = FALSE;
+
+static gboolean open_device() {
+	if (device) {
+		return TRUE;
+	}
+	cold_opens++;
+	if (device_haptic_open(0, &device) != DEVICE_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to get vibrator!");
+		device = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void close_device() {
+	if (device) {
+		device_haptic_close(device);
+		device = NULL;
+	}
+}
+
+static void record_latency() {
+	const double latency_ms = (ecore_time_get() - playback.first_pulse_due) * 1000.0;
+	unsigned int bucket = 0;
+	while (bucket < LATENCY_BUCKETS - 1 && latency_ms >= latency_bounds[bucket]) {
+		bucket++;
+	}
+	latency_histogram[bucket]++;
+	playback.first_pulse_due = 0;
+	dlog_print(DLOG_INFO, TAG, "Haptic %s: first pulse %.0f ms after the request", pattern_names[playback.pattern], latency_ms);
+}
+
+static Eina_Bool pulse_cb(void *data);
+
+static void finish() {
+	if (!playback.playing) {
+		return;
+	}
+	playback.playing = FALSE;
+	if (playback.timer) {
+		scheduler_timer_del(playback.timer);
+		playback.timer = NULL;
+	}
+	if (device && effect) {
+		device_haptic_stop(device, effect);
+	}
+	effect = NULL;
+	if (!warm) {
+		close_device();
+	}
+	power_lock_cpu_release();
+
+	const double minutes = (ecore_time_get() - playback.started_at) / 60.0;
+	dlog_print(DLOG_INFO, TAG, "Haptic %s: %d wakeups in %.1f min (%.1f per minute)",
+			pattern_names[playback.pattern], playback.wakeups, minutes, minutes > 0 ? playback.wakeups / minutes : 0.0);
+}
+
+static void schedule(double delay_sec) {
+	playback.timer = scheduler_timer_add(delay_sec, 0, pulse_cb, NULL);
+}
+
+static Eina_Bool pulse_cb(void *data EINA_UNUSED) {
+	playback.timer = NULL;
+	playback.wakeups++;
+
+	while (playback.left == 0) {
+		if (++playback.step >= playback.step_count) {
+			finish();
+			return ECORE_CALLBACK_CANCEL;
+		}
+		playback.left = playback.steps[playback.step].count;
+	}
+
+	const haptic_step_s *step = &playback.steps[playback.step];
+	if (device_haptic_vibrate(device, step->on_ms, step->feedback, &effect) != DEVICE_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to vibrate");
+	}
+	if (playback.first_pulse_due > 0) {
+		record_latency();
+	}
+	if (playback.left > 0) {
+		playback.left--;
+	}
+	if (playback.left == 0 && playback.step == playback.step_count - 1) {
+		// Last pulse, release everything once it had time to play.
+		schedule(step->on_ms / 1000.0);
+		playback.step = playback.step_count;
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	schedule(step->period_ms / 1000.0);
+	return ECORE_CALLBACK_CANCEL;
+}
+
+gboolean haptic_pattern_play(haptic_pattern_e pattern, int repeats, double delay_sec, double requested_at) {
+	if (playback.playing && playback.pattern == HAPTIC_PATTERN_ALARM && pattern == HAPTIC_PATTERN_HINT) {
+		dlog_print(DLOG_INFO, TAG, "Hint dropped, alarm is vibrating");
+		return FALSE;
+	}
+	if (playback.playing && playback.pattern == HAPTIC_PATTERN_ALARM && pattern == HAPTIC_PATTERN_ALARM) {
+		// The phone's alarm following one the watch fired itself, the crescendo keeps its step.
+		dlog_print(DLOG_INFO, TAG, "Alarm already vibrating, step %d kept", playback.step);
+		if (playback.first_pulse_due == 0) {
+			// The request was served by a pulse that is already playing.
+			playback.first_pulse_due = requested_at;
+			record_latency();
+		}
+		return TRUE;
+	}
+	if (playback.playing) {
+		dlog_print(DLOG_INFO, TAG, "Haptic %s replaces %s", pattern_names[pattern], pattern_names[playback.pattern]);
+		finish();
+	}
+
+	if (pattern == HAPTIC_PATTERN_HINT) {
+		if (repeats <= 0) {
+			return FALSE;
+		}
+		playback.hint_step.on_ms = 1000;
+		playback.hint_step.feedback = 100;
+		playback.hint_step.period_ms = 2000;
+		playback.hint_step.count = repeats;
+		playback.steps = &playback.hint_step;
+		playback.step_count = 1;
+	} else {
+		playback.steps = alarm_steps;
+		playback.step_count = sizeof(alarm_steps) / sizeof(alarm_steps[0]);
+	}
+
+	if (!open_device()) {
+		return FALSE;
+	}
+	// Pulses are timer driven, they must not wait for the next epoch wakeup.
+	power_lock_cpu_acquire();
+
+	playback.playing = TRUE;
+	playback.pattern = pattern;
+	playback.step = 0;
+	playback.left = playback.steps[0].count;
+	playback.started_at = ecore_time_get();
+	playback.wakeups = 0;
+	if (delay_sec < IMMEDIATE_SEC) {
+		playback.first_pulse_due = requested_at;
+		pulse_cb(NULL);
+	} else {
+		playback.first_pulse_due = requested_at + delay_sec;
+		schedule(delay_sec);
+	}
+	return TRUE;
+}
+
+void haptic_pattern_stop(haptic_pattern_e pattern) {
+	if (playback.playing && playback.pattern == pattern) {
+		finish();
+	}
+}
+
+void haptic_pattern_set_warm(gboolean keep_warm) {
+	warm = keep_warm;
+	if (warm) {
+		open_device();
+	} else if (!playback.playing) {
+		close_device();
+	}
+}
+
+void haptic_pattern_reset_stats() {
+	memset(latency_histogram, 0, sizeof(latency_histogram));
+	cold_opens = 0;
+}
+
+void haptic_pattern_log_stats() {
+	Eina_Strbuf *strbuf = eina_strbuf_new();
+	for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+		if (i < LATENCY_BUCKETS - 1) {
+			eina_strbuf_append_printf(strbuf, " <%dms:%d", latency_bounds[i], latency_histogram[i]);
+		} else {
+			eina_strbuf_append_printf(strbuf, " >=%dms:%d", latency_bounds[i - 1], latency_histogram[i]);
+		}
+	}
+	dlog_print(DLOG_INFO, TAG, "Haptic latency:%s, vibrator opens %d", eina_strbuf_string_get(strbuf), cold_opens);
+	eina_strbuf_free(strbuf);
+}
@@ -0,0 +1,123 @@
+#include "hr_estimator.h"
+
+#include "common.h"
+
+#include <dlog.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Plausible heart rates, anything else is the sensor still searching (it reports 0 then) or a bad fit.
+#define MIN_BPM 20.0f
+#define MAX_BPM 200.0f
+// Latest samples the median and MAD are taken over.
+#define WINDOW 15
+// Fewest samples we believe, a couple of early samples agreeing by chance is common.
+#define MIN_SAMPLES 5
+// Converged when the MAD is within this many bpm or this fraction of the median, whichever is larger.
+#define TOLERANCE_BPM 2.0f
+#define TOLERANCE_RATIO 0.03f
+// Samples without convergence after which we stop anyway, the old code's fixed 10 samples plus margin.
+#define MAX_SAMPLES 30
+// Samples needed to report anything when giving up.
+#define MIN_SAMPLES_ON_GIVE_UP 3
+
+static float window[WINDOW];
+static int window_len = 0;
+static int window_pos = 0;
+static int samples = 0;
+static int rejected = 0;
+
+static int compare_float(const void *a, const void *b) {
+	const float fa = *(const float*)a;
+	const float fb = *(const float*)b;
+	return (fa > fb) - (fa < fb);
+}
+
+static float median_of(float *values, int len) {
+	qsort(values, len, sizeof(float), compare_float);
+	return len % 2 ? values[len / 2] : (values[len / 2 - 1] + values[len / 2]) / 2.0f;
+}
+
+static float tolerance_for(float median) {
+	return fmaxf(TOLERANCE_BPM, median * TOLERANCE_RATIO);
+}
+
+// Fills the estimate from the current window and returns the MAD.
+static float estimate_from_window(hr_estimate_s *estimate) {
+	float sorted[WINDOW];
+	float deviations[WINDOW];
+
+	memcpy(sorted, window, window_len * sizeof(float));
+	const float median = median_of(sorted, window_len);
+	for (int i = 0; i < window_len; i++) {
+		deviations[i] = fabsf(window[i] - median);
+	}
+	const float mad = median_of(deviations, window_len);
+
+	// Full confidence for identical samples, none once the spread is three tolerances wide.
+	float confidence = 1.0f - mad / (3.0f * tolerance_for(median));
+	if (confidence < 0.0f) {
+		confidence = 0.0f;
+	}
+	// Few samples can not be fully trusted however well they agree.
+	if (window_len < WINDOW) {
+		confidence *= (float)window_len / WINDOW * 0.5f + 0.5f;
+	}
+
+	estimate->bpm = median;
+	estimate->confidence = confidence;
+	estimate->samples = samples;
+	return mad;
+}
+
+void hr_estimator_reset() {
+	window_len = 0;
+	window_pos = 0;
+	samples = 0;
+	rejected = 0;
+}
+
+hr_estimate_status_e hr_estimator_add(float bpm, hr_estimate_s *estimate) {
+	if (bpm <= MIN_BPM || bpm >= MAX_BPM) {
+		rejected++;
+		return HR_ESTIMATE_PENDING;
+	}
+
+	window[window_pos] = bpm;
+	window_pos = (window_pos + 1) % WINDOW;
+	if (window_len < WINDOW) {
+		window_len++;
+	}
+	samples++;
+
+	if (samples < MIN_SAMPLES) {
+		return HR_ESTIMATE_PENDING;
+	}
+
+	const float mad = estimate_from_window(estimate);
+	if (mad <= tolerance_for(estimate->bpm)) {
+		dlog_print(DLOG_INFO, TAG, "HR converged: %.1f bpm, MAD %.1f, confidence %.2f after %d samples (%d rejected)",
+				estimate->bpm, mad, estimate->confidence, samples, rejected);
+		return HR_ESTIMATE_CONVERGED;
+	}
+	if (samples >= MAX_SAMPLES) {
+		return hr_estimator_give_up(estimate);
+	}
+	return HR_ESTIMATE_PENDING;
+}
+
+hr_estimate_status_e hr_estimator_give_up(hr_estimate_s *estimate) {
+	if (window_len < MIN_SAMPLES_ON_GIVE_UP) {
+		dlog_print(DLOG_INFO, TAG, "HR gave up without a reading: %d samples, %d rejected", samples, rejected);
+		estimate->samples = 0;
+		estimate->confidence = 0;
+		estimate->bpm = 0;
+		return HR_ESTIMATE_GAVE_UP;
+	}
+
+	const float mad = estimate_from_window(estimate);
+	dlog_print(DLOG_INFO, TAG, "HR gave up: %.1f bpm, MAD %.1f, confidence %.2f after %d samples (%d rejected)",
+			estimate->bpm, mad, estimate->confidence, samples, rejected);
+	return HR_ESTIMATE_GAVE_UP;
+}
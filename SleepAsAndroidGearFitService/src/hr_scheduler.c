@@ -0,0 +1,125 @@
+#include "hr_scheduler.h"
+
+#include "common.h"
+
+#include <dlog.h>
+#include <string.h>
+
+// Epoch max_sum above which we count the epoch as movement. Still wrist noise stays well below.
+#define MOVEMENT_THRESHOLD 1.0f
+// Movement this recent means a possible arousal, older movement still hints at light sleep.
+#define AROUSAL_WINDOW_SEC 60
+#define LIGHT_WINDOW_SEC (15 * 60)
+
+// Pause between the end of one measurement and the start of the next, per movement level.
+#define AROUSAL_INTERVAL_SEC (2 * 60)
+#define LIGHT_INTERVAL_SEC (5 * 60)
+#define STILL_INTERVAL_SEC (15 * 60)
+
+// HRM LED time we allow for one night, spread over NIGHT_SEC. Ahead of that pace the intervals are doubled.
+#define BUDGET_SEC (40 * 60)
+#define NIGHT_SEC (8 * 60 * 60)
+
+typedef enum {
+	LEVEL_AROUSAL,
+	LEVEL_LIGHT,
+	LEVEL_STILL,
+	LEVEL_COUNT
+} movement_level_e;
+
+static const char *level_names[LEVEL_COUNT] = { "arousal", "light", "still" };
+
+static int epoch_sec = 10;
+static long epochs = 0;
+static long epochs_since_movement = -1;
+static long epochs_since_measurement = 0;
+static double budget_used = 0;
+static movement_level_e started_level = LEVEL_LIGHT;
+
+static struct {
+	int started[LEVEL_COUNT];
+	int paced_epochs;
+	int over_budget_epochs;
+} stats;
+
+static movement_level_e current_level() {
+	if (epochs_since_movement < 0) {
+		return LEVEL_STILL;
+	}
+	const long since_sec = epochs_since_movement * epoch_sec;
+	if (since_sec <= AROUSAL_WINDOW_SEC) {
+		return LEVEL_AROUSAL;
+	}
+	if (since_sec <= LIGHT_WINDOW_SEC) {
+		return LEVEL_LIGHT;
+	}
+	return LEVEL_STILL;
+}
+
+static int interval_sec(movement_level_e level) {
+	switch (level) {
+		case LEVEL_AROUSAL:
+			return AROUSAL_INTERVAL_SEC;
+		case LEVEL_LIGHT:
+			return LIGHT_INTERVAL_SEC;
+		default:
+			return STILL_INTERVAL_SEC;
+	}
+}
+
+void hr_scheduler_reset(int sec) {
+	epoch_sec = sec > 0 ? sec : 1;
+	epochs = 0;
+	epochs_since_movement = -1;
+	epochs_since_measurement = 0;
+	budget_used = 0;
+	started_level = LEVEL_LIGHT;
+	memset(&stats, 0, sizeof(stats));
+}
+
+gboolean hr_scheduler_on_epoch(float max_sum) {
+	epochs++;
+	epochs_since_measurement++;
+	if (max_sum >= MOVEMENT_THRESHOLD) {
+		epochs_since_movement = 0;
+	} else if (epochs_since_movement >= 0) {
+		epochs_since_movement++;
+	}
+
+	if (budget_used >= BUDGET_SEC) {
+		stats.over_budget_epochs++;
+		return FALSE;
+	}
+
+	const movement_level_e level = current_level();
+	long wait_sec = interval_sec(level);
+	const double elapsed_sec = (double)epochs * epoch_sec;
+	if (budget_used > BUDGET_SEC * (elapsed_sec / NIGHT_SEC)) {
+		// Spending faster than the night allows, slow down until the pace is back.
+		wait_sec *= 2;
+		stats.paced_epochs++;
+	}
+
+	if (epochs_since_measurement * epoch_sec < wait_sec) {
+		return FALSE;
+	}
+
+	started_level = level;
+	epochs_since_measurement = 0;
+	return TRUE;
+}
+
+void hr_scheduler_on_measurement_done(double sensor_on_sec) {
+	budget_used += sensor_on_sec;
+	stats.started[started_level]++;
+	// The pause is counted from the end of the measurement, not its start.
+	epochs_since_measurement = 0;
+	dlog_print(DLOG_INFO, TAG, "HR measurement (%s) took %.0f s, budget used %.0f/%d s",
+			level_names[started_level], sensor_on_sec, budget_used, BUDGET_SEC);
+}
+
+void hr_scheduler_log_stats() {
+	dlog_print(DLOG_INFO, TAG, "HR schedule: %d arousal, %d light, %d still measurements, budget %.0f/%d s, paced epochs %d, over budget epochs %d",
+			stats.started[LEVEL_AROUSAL], stats.started[LEVEL_LIGHT], stats.started[LEVEL_STILL],
+			budget_used, BUDGET_SEC, stats.paced_epochs, stats.over_budget_epochs);
+}
@@ -0,0 +1,66 @@
+#include "power_lock.h"
+
+#include "common.h"
+
+#include <device/power.h>
+#include <dlog.h>
+#include <Ecore.h>
+
+static int lock_count = 0;
+// When the lock was taken (wall clock, the monotonic clock stops while the device sleeps).
+static double locked_at = 0;
+static double held_sec = 0;
+static double stats_since = 0;
+static long acquisitions = 0;
+
+void power_lock_cpu_acquire() {
+	if (lock_count++ > 0) {
+		return;
+	}
+
+	int err = device_power_request_lock(POWER_LOCK_CPU, 0);
+	if (err != DEVICE_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to lock CPU (%d)", err);
+	}
+	locked_at = ecore_time_unix_get();
+	acquisitions++;
+}
+
+void power_lock_cpu_release() {
+	if (lock_count == 0) {
+		dlog_print(DLOG_ERROR, TAG, "CPU lock released without being held");
+		return;
+	}
+	if (--lock_count > 0) {
+		return;
+	}
+
+	int err = device_power_release_lock(POWER_LOCK_CPU);
+	if (err != DEVICE_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to unlock CPU (%d)", err);
+	}
+	held_sec += ecore_time_unix_get() - locked_at;
+}
+
+double power_lock_cpu_held_sec() {
+	if (lock_count > 0) {
+		return held_sec + ecore_time_unix_get() - locked_at;
+	}
+	return held_sec;
+}
+
+void power_lock_reset_stats() {
+	stats_since = ecore_time_unix_get();
+	held_sec = 0;
+	acquisitions = 0;
+	if (lock_count > 0) {
+		locked_at = stats_since;
+	}
+}
+
+void power_lock_log_stats() {
+	const double total = ecore_time_unix_get() - stats_since;
+	const double held = power_lock_cpu_held_sec();
+	dlog_print(DLOG_INFO, TAG, "CPU lock: held %.0f of %.0f sec (%.1f%% duty cycle), %ld acquisitions",
+			held, total, total > 0 ? 100.0 * held / total : 0.0, acquisitions);
+}
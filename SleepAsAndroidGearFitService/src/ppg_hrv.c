@@ -0,0 +1,219 @@
+#include "ppg_hrv.h"
+
+#include "common.h"
+
+#include <dlog.h>
+#include <math.h>
+
+// Pass band around the plausible pulse frequencies (30 to 240 bpm), removes drift and sensor noise.
+#define HIGH_PASS_HZ 0.5f
+#define LOW_PASS_HZ 4.0f
+#define BUTTERWORTH_Q 0.7071f
+// Filters need a moment to settle after the LED turns on, peaks before that are ignored.
+#define SETTLE_SEC 1.0f
+// No two beats closer than this (200 bpm).
+#define REFRACTORY_US 300000ULL
+// Peaks below this fraction of the recent peak amplitude are noise or dicrotic notches.
+#define PEAK_THRESHOLD 0.4f
+// Per sample decay of the peak envelope, lets it recover after a motion artifact.
+#define ENVELOPE_DECAY 0.998f
+// Plausible RR intervals.
+#define MIN_RR_MS 300.0f
+#define MAX_RR_MS 2000.0f
+// An RR differing from the running mean by more than this is a missed or extra beat.
+#define MAX_RR_JUMP 0.3f
+// After this many rejections in a row the running mean is considered wrong and restarted.
+#define MAX_REJECT_STREAK 3
+// Fewest RR intervals a summary is reported for, below that SDNN and RMSSD are dominated by single beats.
+#define MIN_RR_COUNT 20
+// More rejected than accepted intervals means the accepted ones are as likely to be noise peaks.
+#define MAX_REJECTED_SHARE 0.5f
+// Pulse amplitudes vary with breathing by a few tens of percent, peaks of filtered noise by about half their mean.
+#define MAX_AMPLITUDE_CV 0.35
+
+typedef struct biquad {
+	float b0, b1, b2, a1, a2;
+	float z1, z2;
+} biquad_s;
+
+static biquad_s high_pass;
+static biquad_s low_pass;
+
+static int settle_samples = 0;
+static long samples = 0;
+
+// Last two filtered samples, a peak is the middle one of three.
+static float prev1 = 0, prev2 = 0;
+static unsigned long long prev1_at = 0;
+static unsigned long long sample_us = 0;
+static float envelope = 0;
+
+static unsigned long long last_peak_at = 0;
+static float last_rr = 0;
+static gboolean last_rr_accepted = FALSE;
+static int reject_streak = 0;
+
+static double rr_sum = 0;
+static double rr_sq_sum = 0;
+static double diff_sq_sum = 0;
+static int rr_count = 0;
+static int diff_count = 0;
+static int rr_rejected = 0;
+// Amplitudes of the peaks closing accepted RR intervals.
+static double amplitude_sum = 0;
+static double amplitude_sq_sum = 0;
+
+// RBJ cookbook coefficients, normalized by a0.
+static void biquad_init(biquad_s *f, float cutoff_hz, float rate_hz, gboolean high) {
+	const float w0 = 2.0f * (float)M_PI * cutoff_hz / rate_hz;
+	const float cos_w0 = cosf(w0);
+	const float alpha = sinf(w0) / (2.0f * BUTTERWORTH_Q);
+	const float a0 = 1.0f + alpha;
+
+	if (high) {
+		f->b0 = (1.0f + cos_w0) / 2.0f / a0;
+		f->b1 = -(1.0f + cos_w0) / a0;
+	} else {
+		f->b0 = (1.0f - cos_w0) / 2.0f / a0;
+		f->b1 = (1.0f - cos_w0) / a0;
+	}
+	f->b2 = f->b0;
+	f->a1 = -2.0f * cos_w0 / a0;
+	f->a2 = (1.0f - alpha) / a0;
+	f->z1 = 0;
+	f->z2 = 0;
+}
+
+// Transposed direct form II.
+static float biquad_run(biquad_s *f, float x) {
+	const float y = f->b0 * x + f->z1;
+	f->z1 = f->b1 * x - f->a1 * y + f->z2;
+	f->z2 = f->b2 * x - f->a2 * y;
+	return y;
+}
+
+static void add_rr(float rr, float amplitude) {
+	if (rr < MIN_RR_MS || rr > MAX_RR_MS) {
+		rr_rejected++;
+		last_rr_accepted = FALSE;
+		return;
+	}
+
+	if (rr_count > 0 && fabs(rr - rr_sum / rr_count) > MAX_RR_JUMP * (rr_sum / rr_count)) {
+		rr_rejected++;
+		last_rr_accepted = FALSE;
+		if (++reject_streak < MAX_REJECT_STREAK) {
+			return;
+		}
+		// The beats we locked on were the wrong ones, start over from here.
+		rr_sum = 0;
+		rr_sq_sum = 0;
+		diff_sq_sum = 0;
+		rr_count = 0;
+		diff_count = 0;
+		amplitude_sum = 0;
+		amplitude_sq_sum = 0;
+	}
+	reject_streak = 0;
+
+	// Successive differences only between neighbouring clean beats.
+	if (last_rr_accepted) {
+		diff_sq_sum += (rr - last_rr) * (rr - last_rr);
+		diff_count++;
+	}
+	rr_sum += rr;
+	rr_sq_sum += rr * rr;
+	rr_count++;
+	amplitude_sum += amplitude;
+	amplitude_sq_sum += amplitude * amplitude;
+	last_rr = rr;
+	last_rr_accepted = TRUE;
+}
+
+static void on_peak(unsigned long long at, float amplitude) {
+	if (amplitude < PEAK_THRESHOLD * envelope) {
+		return;
+	}
+	if (last_peak_at != 0 && at - last_peak_at < REFRACTORY_US) {
+		return;
+	}
+	envelope = envelope * 0.8f + amplitude * 0.2f;
+
+	if (last_peak_at != 0) {
+		add_rr((at - last_peak_at) / 1000.0f, amplitude);
+	}
+	last_peak_at = at;
+}
+
+void ppg_hrv_reset(float sample_rate_hz) {
+	biquad_init(&high_pass, HIGH_PASS_HZ, sample_rate_hz, TRUE);
+	biquad_init(&low_pass, LOW_PASS_HZ, sample_rate_hz, FALSE);
+	settle_samples = (int)(SETTLE_SEC * sample_rate_hz);
+	sample_us = (unsigned long long)(1e6f / sample_rate_hz);
+	samples = 0;
+	prev1 = prev2 = 0;
+	prev1_at = 0;
+	envelope = 0;
+	last_peak_at = 0;
+	last_rr = 0;
+	last_rr_accepted = FALSE;
+	reject_streak = 0;
+	rr_sum = rr_sq_sum = diff_sq_sum = 0;
+	rr_count = diff_count = rr_rejected = 0;
+	amplitude_sum = amplitude_sq_sum = 0;
+}
+
+void ppg_hrv_add(unsigned long long timestamp_us, float value) {
+	// More blood in the tissue reflects less green light, the pulse peak is a dip in the raw signal.
+	const float y = biquad_run(&low_pass, biquad_run(&high_pass, -value));
+	samples++;
+
+	if (samples > settle_samples) {
+		envelope *= ENVELOPE_DECAY;
+		if (prev1 > prev2 && prev1 >= y && prev1 > 0) {
+			// The sample period is 10 ms, far coarser than the beat to beat changes. A parabola through the three
+			// samples puts the peak between them.
+			const float curvature = prev2 - 2.0f * prev1 + y;
+			const float offset = curvature < 0 ? 0.5f * (prev2 - y) / curvature : 0;
+			on_peak(prev1_at + (long long)(offset * sample_us), prev1);
+		}
+	}
+
+	prev2 = prev1;
+	prev1 = y;
+	prev1_at = timestamp_us;
+}
+
+int ppg_hrv_rr_count() {
+	return rr_count;
+}
+
+gboolean ppg_hrv_summary(ppg_hrv_summary_s *summary) {
+	if (rr_count < MIN_RR_COUNT || diff_count == 0) {
+		dlog_print(DLOG_INFO, TAG, "HRV: not enough beats, %d RR accepted, %d rejected in %ld samples",
+				rr_count, rr_rejected, samples);
+		return FALSE;
+	}
+	if (rr_rejected > MAX_REJECTED_SHARE * (rr_count + rr_rejected)) {
+		dlog_print(DLOG_INFO, TAG, "HRV: too many artifacts, %d RR accepted, %d rejected", rr_count, rr_rejected);
+		return FALSE;
+	}
+	const double amplitude_mean = amplitude_sum / rr_count;
+	const double amplitude_variance = amplitude_sq_sum / rr_count - amplitude_mean * amplitude_mean;
+	if (amplitude_variance > 0 && sqrt(amplitude_variance) > MAX_AMPLITUDE_CV * amplitude_mean) {
+		dlog_print(DLOG_INFO, TAG, "HRV: irregular peaks, amplitude CV %.2f over %d RR",
+				sqrt(amplitude_variance) / amplitude_mean, rr_count);
+		return FALSE;
+	}
+
+	const double mean = rr_sum / rr_count;
+	const double variance = (rr_sq_sum - rr_count * mean * mean) / (rr_count - 1);
+	summary->mean_rr_ms = mean;
+	summary->sdnn_ms = variance > 0 ? sqrt(variance) : 0;
+	summary->rmssd_ms = sqrt(diff_sq_sum / diff_count);
+	summary->rr_count = rr_count;
+
+	dlog_print(DLOG_INFO, TAG, "HRV: mean RR %.0f ms, SDNN %.1f ms, RMSSD %.1f ms from %d RR (%d rejected)",
+			summary->mean_rr_ms, summary->sdnn_ms, summary->rmssd_ms, rr_count, rr_rejected);
+	return TRUE;
+}
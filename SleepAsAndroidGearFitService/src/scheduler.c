@@ -0,0 +1,266 @@
+#include "scheduler.h"
+
+#include "common.h"
+
+#include <dlog.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Resolution of the wheel.
+#define TICK_SEC 0.25
+// Each level has 64 slots, one slot of a level spans the whole level below it.
+// With 3 levels the wheel covers 64^3 ticks (~18 hours), later timers are parked in the last slot and re-placed.
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 3
+#define WHEEL_SPAN ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+struct scheduler_timer {
+	// Tick at which the timer is due.
+	uint64_t expires;
+	// Ticks the timer may be deferred to share a wakeup.
+	uint64_t slack;
+	uint64_t interval;
+	Ecore_Task_Cb cb;
+	const void *data;
+	// Slot (or the due list) the timer currently sits in.
+	Eina_List **list;
+	bool firing;
+	bool deleted;
+};
+
+static Eina_List *wheel[WHEEL_LEVELS][WHEEL_SIZE];
+// Timers whose tick has passed and which are about to be fired.
+static Eina_List *due = NULL;
+// Last tick the wheel was advanced to.
+static uint64_t wheel_tick = 0;
+static double base_time = -1;
+static int timer_count = 0;
+
+// The only Ecore timer of the service, armed for the next wakeup the wheel needs.
+static Ecore_Timer *wakeup_timer = NULL;
+
+static long wakeups = 0;
+static long fired = 0;
+static double stats_since = 0;
+
+static Eina_Bool wakeup_cb(void *data);
+
+static uint64_t now_tick() {
+	if (base_time < 0) {
+		base_time = ecore_time_get();
+	}
+	// Small tolerance so a wakeup armed exactly for a tick does not land just before it.
+	return (uint64_t)((ecore_time_get() - base_time) / TICK_SEC + 0.01);
+}
+
+static uint64_t secs_to_ticks(double secs) {
+	return secs <= 0 ? 0 : (uint64_t)(secs / TICK_SEC + 0.5);
+}
+
+static void place(scheduler_timer_s *timer) {
+	uint64_t expires = timer->expires;
+	if (expires <= wheel_tick) {
+		// Already due, e.g. cascaded down on its own tick. The slot of this tick has been emptied, fire it now.
+		due = eina_list_append(due, timer);
+		timer->list = &due;
+		return;
+	}
+	uint64_t delta = expires - wheel_tick;
+	if (delta >= WHEEL_SPAN) {
+		expires = wheel_tick + WHEEL_SPAN - 1;
+		delta = WHEEL_SPAN - 1;
+	}
+
+	int level = 0;
+	while (level < WHEEL_LEVELS - 1 && delta >= ((uint64_t)1 << (WHEEL_BITS * (level + 1)))) {
+		level++;
+	}
+
+	Eina_List **slot = &wheel[level][(expires >> (WHEEL_BITS * level)) & WHEEL_MASK];
+	*slot = eina_list_append(*slot, timer);
+	timer->list = slot;
+}
+
+static void unlink_timer(scheduler_timer_s *timer) {
+	if (timer->list) {
+		*timer->list = eina_list_remove(*timer->list, timer);
+		timer->list = NULL;
+	}
+}
+
+static void cascade(int level, int idx) {
+	Eina_List *list = wheel[level][idx];
+	scheduler_timer_s *timer;
+
+	wheel[level][idx] = NULL;
+	EINA_LIST_FREE(list, timer) {
+		place(timer);
+	}
+}
+
+static void advance(uint64_t target) {
+	scheduler_timer_s *timer;
+
+	while (wheel_tick < target) {
+		wheel_tick++;
+
+		// Higher levels first, what they release may land in a slot of the level below that is cascaded right after.
+		for (int level = WHEEL_LEVELS - 1; level > 0; level--) {
+			const uint64_t level_mask = ((uint64_t)1 << (WHEEL_BITS * level)) - 1;
+			if ((wheel_tick & level_mask) == 0) {
+				cascade(level, (wheel_tick >> (WHEEL_BITS * level)) & WHEEL_MASK);
+			}
+		}
+
+		Eina_List *list = wheel[0][wheel_tick & WHEEL_MASK];
+		wheel[0][wheel_tick & WHEEL_MASK] = NULL;
+		EINA_LIST_FREE(list, timer) {
+			due = eina_list_append(due, timer);
+			timer->list = &due;
+		}
+	}
+}
+
+static void fire_due() {
+	while (due) {
+		scheduler_timer_s *timer = eina_list_data_get(due);
+		due = eina_list_remove_list(due, due);
+		timer->list = NULL;
+
+		timer->firing = true;
+		const Eina_Bool renew = timer->cb((void *)timer->data);
+		timer->firing = false;
+		fired++;
+
+		if (!renew || timer->deleted) {
+			free(timer);
+			timer_count--;
+			continue;
+		}
+
+		// Keep the phase of periodic timers instead of drifting by our own latency.
+		do {
+			timer->expires += timer->interval;
+		} while (timer->expires <= wheel_tick);
+		place(timer);
+	}
+}
+
+// Arms the single Ecore timer for the earliest moment some timer can no longer be deferred.
+static void rearm() {
+	uint64_t next = UINT64_MAX;
+	scheduler_timer_s *timer;
+	Eina_List *l;
+
+	if (due) {
+		next = wheel_tick;
+	}
+	for (int level = 0; level < WHEEL_LEVELS; level++) {
+		for (int idx = 0; idx < WHEEL_SIZE; idx++) {
+			EINA_LIST_FOREACH(wheel[level][idx], l, timer) {
+				if (timer->expires + timer->slack < next) {
+					next = timer->expires + timer->slack;
+				}
+			}
+		}
+	}
+
+	if (wakeup_timer) {
+		ecore_timer_del(wakeup_timer);
+		wakeup_timer = NULL;
+	}
+	if (next == UINT64_MAX) {
+		return;
+	}
+
+	double delay = base_time + next * TICK_SEC - ecore_time_get();
+	if (delay < 0) {
+		delay = 0;
+	}
+	wakeup_timer = ecore_timer_add(delay, wakeup_cb, NULL);
+}
+
+static Eina_Bool wakeup_cb(void *data EINA_UNUSED) {
+	wakeup_timer = NULL;
+	wakeups++;
+
+	// Everything due by now fires on this wakeup, including deferrable timers that still had slack left.
+	advance(now_tick());
+	fire_due();
+	rearm();
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+scheduler_timer_s *scheduler_timer_add(double interval, double slack, Ecore_Task_Cb cb, const void *data) {
+	scheduler_timer_s *timer = calloc(1, sizeof(scheduler_timer_s));
+	if (!timer) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to allocate timer");
+		return NULL;
+	}
+
+	const uint64_t now = now_tick();
+	if (timer_count == 0 && !due) {
+		// Nothing is waiting, skip the idle ticks instead of walking them later.
+		wheel_tick = now;
+	}
+
+	timer->interval = secs_to_ticks(interval);
+	if (timer->interval == 0) {
+		timer->interval = 1;
+	}
+	timer->slack = secs_to_ticks(slack);
+	timer->expires = now + timer->interval;
+	timer->cb = cb;
+	timer->data = data;
+	timer_count++;
+
+	place(timer);
+	rearm();
+
+	return timer;
+}
+
+void scheduler_timer_del(scheduler_timer_s *timer) {
+	if (!timer) {
+		return;
+	}
+	if (timer->firing) {
+		timer->deleted = true;
+		return;
+	}
+
+	unlink_timer(timer);
+	free(timer);
+	timer_count--;
+	rearm();
+}
+
+void scheduler_timer_delay(scheduler_timer_s *timer, double add) {
+	if (!timer) {
+		return;
+	}
+
+	timer->expires += secs_to_ticks(add);
+	if (timer->firing) {
+		return;
+	}
+
+	unlink_timer(timer);
+	place(timer);
+	rearm();
+}
+
+void scheduler_reset_stats() {
+	wakeups = 0;
+	fired = 0;
+	stats_since = ecore_time_unix_get();
+}
+
+void scheduler_log_stats() {
+	const double hours = (ecore_time_unix_get() - stats_since) / 3600.0;
+	dlog_print(DLOG_INFO, TAG, "Scheduler: %ld wakeups, %ld timer callbacks, %.1f wakeups per hour",
+			wakeups, fired, hours > 0 ? wakeups / hours : 0.0);
+}
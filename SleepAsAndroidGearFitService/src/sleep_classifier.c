@@ -0,0 +1,95 @@
+#include "sleep_classifier.h"
+
+#include "common.h"
+
+#include <dlog.h>
+#include <string.h>
+
+// Cole-Kripke 1992 weights for one minute epochs: four minutes before, the scored one, two after.
+#define LOOK_BEHIND 4
+#define LOOK_AHEAD 2
+#define WINDOW (LOOK_BEHIND + 1 + LOOK_AHEAD)
+static const float weights[WINDOW] = { 106, 54, 58, 76, 230, 74, 67 };
+#define SCALE 0.001f
+// Minute activity is the sum of the epochs' max_sum. Capped so a single violent move does not
+// keep the whole window awake, like the count cap of the original actigraph.
+#define ACTIVITY_CAP 10.0f
+// Sleep minutes scoring below this, after DEEP_AFTER_MINUTES of uninterrupted sleep, count as deep.
+#define DEEP_SCORE 0.5f
+#define DEEP_AFTER_MINUTES 10
+
+static int epochs_per_minute = 6;
+static int epochs_in_minute = 0;
+static float minute_activity = 0;
+// Last WINDOW minute activities, minute n sits in activity[n % WINDOW].
+static float activity[WINDOW];
+static int minutes = 0;
+static int sleep_streak = 0;
+static sleep_stage_e current = SLEEP_STAGE_UNKNOWN;
+static int stage_minutes[SLEEP_STAGE_DEEP + 1];
+
+void sleep_classifier_reset(int epoch_sec) {
+	epochs_per_minute = epoch_sec > 0 && epoch_sec < 60 ? 60 / epoch_sec : 1;
+	epochs_in_minute = 0;
+	minute_activity = 0;
+	memset(activity, 0, sizeof(activity));
+	minutes = 0;
+	sleep_streak = 0;
+	current = SLEEP_STAGE_UNKNOWN;
+	memset(stage_minutes, 0, sizeof(stage_minutes));
+}
+
+static sleep_stage_e score(int scored) {
+	float d = 0;
+	for (int i = 0; i < WINDOW; i++) {
+		// Minutes before the start of tracking count as still.
+		const int m = scored - LOOK_BEHIND + i;
+		if (m >= 0) {
+			d += weights[i] * activity[m % WINDOW];
+		}
+	}
+	d *= SCALE;
+
+	if (d >= 1.0f) {
+		sleep_streak = 0;
+		return SLEEP_STAGE_WAKE;
+	}
+	sleep_streak++;
+	if (d < DEEP_SCORE && sleep_streak > DEEP_AFTER_MINUTES) {
+		return SLEEP_STAGE_DEEP;
+	}
+	return SLEEP_STAGE_LIGHT;
+}
+
+gboolean sleep_classifier_add_epoch(float max_sum, int *minute, sleep_stage_e *stage) {
+	minute_activity += max_sum;
+	if (++epochs_in_minute < epochs_per_minute) {
+		return FALSE;
+	}
+
+	activity[minutes % WINDOW] = minute_activity < ACTIVITY_CAP ? minute_activity : ACTIVITY_CAP;
+	minutes++;
+	epochs_in_minute = 0;
+	minute_activity = 0;
+
+	// The newest minute is the last one the window looks ahead to.
+	const int scored = minutes - 1 - LOOK_AHEAD;
+	if (scored < 0) {
+		return FALSE;
+	}
+
+	current = score(scored);
+	stage_minutes[current]++;
+	*minute = scored;
+	*stage = current;
+	return TRUE;
+}
+
+sleep_stage_e sleep_classifier_current() {
+	return current;
+}
+
+void sleep_classifier_log_stats() {
+	dlog_print(DLOG_INFO, TAG, "Sleep stages: %d min wake, %d min light, %d min deep",
+			stage_minutes[SLEEP_STAGE_WAKE], stage_minutes[SLEEP_STAGE_LIGHT], stage_minutes[SLEEP_STAGE_DEEP]);
+}
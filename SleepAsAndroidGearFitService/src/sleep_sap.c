@@ -20,6 +20,7 @@ struct priv {
 static gboolean agent_created = FALSE;
 
 static data_received_cb data_received_callback;
+static connection_changed_cb connection_changed_callback;
 
 static struct priv priv_data = { 0 };
 
@@ -81,6 +82,7 @@ static void on_service_connection_terminated(sap_peer_agent_h peer_agent,
 
 	sap_socket_destroy(priv_data.socket);
 	priv_data.socket = NULL;
+	connection_changed_callback(FALSE);
 
 	dlog_print(DLOG_INFO, TAG, "status:%d", result);
 }
@@ -124,6 +126,7 @@ static void on_service_connection_created(sap_peer_agent_h peer_agent,
 			send_data("STARTING");  // TODO: This should be send only when started from watch, right?
 			sent_tracking = true;
 		}
+		connection_changed_callback(TRUE);
 		// update_ui("Connection Established");
 		break;
 
@@ -238,6 +241,7 @@ static void on_service_connection_requested(sap_peer_agent_h peer_agent,
 	sap_socket_set_data_received_cb(socket, on_data_recieved, peer_agent);
 
 	sap_peer_agent_accept_service_connection(peer_agent);
+	connection_changed_callback(TRUE);
 }
 
 static gboolean _find_peer_agent(gpointer user_data) {
@@ -266,16 +270,24 @@ gboolean find_peers() {
 
 }
 
-gboolean send_data(char *message) {
+gboolean is_connected() {
+	return priv_data.socket != NULL;
+}
+
+send_result_e send_data(char *message) {
 	int result;
 	if (priv_data.socket) {
 		dlog_print(DLOG_INFO, TAG, "Sending data %s", message);
 		result = sap_socket_send_data(priv_data.socket, SLEEP_CHANNELID, strlen(message), message);
 	} else {
 		// update_ui("No service Connection");
-		return FALSE;
+		return SEND_RESULT_NO_CONNECTION;
 	}
-	return TRUE;
+	if (result != SAP_RESULT_SUCCESS) {
+		dlog_print(DLOG_ERROR, TAG, "Sending data failed (%d)", result);
+		return SEND_RESULT_FAILED;
+	}
+	return SEND_RESULT_OK;
 
 }
 
@@ -355,6 +367,7 @@ static void on_device_status_changed(sap_device_status_e status, sap_transport_t
 		if (priv_data.peer_agent) {
 			sap_socket_destroy(priv_data.socket);
 			priv_data.socket = NULL;
+			connection_changed_callback(FALSE);
 			sap_peer_agent_destroy(priv_data.peer_agent);
 			priv_data.peer_agent = NULL;
 		}
@@ -392,8 +405,9 @@ void terminate_sap() {
 	sap_agent_destroy(priv_data.agent);
 }
 
-void initialize_sap(data_received_cb data_received) {
+void initialize_sap(data_received_cb data_received, connection_changed_cb connection_changed) {
 	data_received_callback = data_received;
+	connection_changed_callback = connection_changed;
 	sap_agent_h agent = NULL;
 
 	sap_agent_create(&agent);
@@ -2,9 +2,21 @@
 
 #include "common.h"
 #include "sleep_sap.h"
+#include "batch_controller.h"
+#include "scheduler.h"
+#include "power_lock.h"
+#include "ui_channel.h"
+#include "state_page.h"
+#include "hr_estimator.h"
+#include "hr_scheduler.h"
+#include "ppg_hrv.h"
+#include "sleep_classifier.h"
+#include "smart_alarm.h"
+#include "haptic_pattern.h"
+#include "wake_alarm.h"
 
-#include <device/haptic.h>
 #include <device/power.h>
+#include <malloc.h>
 #include <efl_extension.h>
 #include <tizen.h>
 #include <sensor.h>
@@ -14,25 +26,79 @@
 // Sampling frequency.. how often do we try to send data, if needed.
 #define SAMPLING_TIME_SEC 10
 #define MAX_BUFFER_LENGTH 100
-
-Ecore_Timer* send_motion_timer;
-Ecore_Timer* update_ui_timer;
-Ecore_Timer* alarm_timer = NULL;
-Ecore_Timer* hint_timer = NULL;
-Ecore_Timer* hr_timer = NULL;
+// Accelerometer sampling interval, stretched while the battery is low. Sample to sample deltas are always
+// scaled to the normal interval, the phone and the on-watch thresholds only know that one.
+#define ACCEL_INTERVAL_MS 100
+#define LOW_BATTERY_ACCEL_INTERVAL_MS 200
+// Batch sizes forced by the degradation modes: few radio wakeups on low battery, nothing kept in memory on low memory.
+// Low battery wins when both apply, low memory then only flushes the queue once.
+#define LOW_BATTERY_BATCH_SIZE 30
+#define LOW_MEMORY_BATCH_SIZE 1
+
+// Green LED PPG sampling during an HR window, only while beat to beat intervals are extracted.
+#define PPG_INTERVAL_MS 10
+// HR readings waiting for the next motion batch.
+#define MAX_HR_BUFFER_LENGTH 32
+// Scored minutes waiting for the next batch.
+#define MAX_STAGE_BUFFER_LENGTH 64
+// In summaries only mode a batch goes out every this many scored minutes.
+#define SUMMARY_BATCH_MINUTES 30
+// Pauses noted for the next batch.
+#define MAX_PAUSE_BUFFER_LENGTH 8
+// Sensors come back this long before a pause ends so the first epoch after it is complete.
+#define PAUSE_REARM_SEC 2
+
+// start_alarm only vibrates for a positive delay, this one is short enough to count as none.
+#define LOCAL_ALARM_DELAY_MS 1
+
+// The HRM LED is never left on longer than this for one measurement.
+#define HR_TIMEOUT_SEC 60
+// With HRV on, the LED stays on after the HR converged until this many clean RR intervals or the timeout.
+#define HRV_TARGET_RR 30
+
+// Deferrable timers may slip by up to one epoch so they ride on the epoch wakeup.
+#define EPOCH_SLACK_SEC SAMPLING_TIME_SEC
+
+scheduler_timer_s* send_motion_timer;
+scheduler_timer_s* pause_timer = NULL;
+scheduler_timer_s* pause_rearm_timer = NULL;
+scheduler_timer_s* smart_alarm_timer = NULL;
+scheduler_timer_s* hr_timeout_timer = NULL;
 
 static bool is_tracking = false;
 static bool hr_enabled = false;
+// Phone takes timestamped HR readings inside the motion batch (HrSeries;true) instead of HR_DATA messages.
+static bool hr_series = false;
+// Phone wants the beat to beat summary of each HR window (Hrv;true), needs the HR series to travel.
+static bool hrv_enabled = false;
+// Phone takes the on-watch stage of every scored minute (StageCodes;true).
+static bool stage_codes = false;
+// Phone wants no epochs at all, only stages and HR in large batches (SummariesOnly;true).
+static bool summaries_only = false;
+// Phone takes a pause as one start,duration marker instead of zero epochs (PauseMarker;true).
+static bool pause_markers = false;
+// Phone asked to hold the CPU lock only while an epoch is processed (EpochCpuLock;true).
+static bool epoch_cpu_lock = false;
+// Epoch mode is really in use, the sensor hub accepted batching and its deliveries drive the epochs.
+static bool epoch_cpu_lock_active = false;
+// Sensor timestamp (us) at which the current epoch ends, used in epoch mode only.
+static unsigned long long epoch_end_timestamp = 0;
 
 // Acceleromter.
 static sensor_listener_h listener;
 static sensor_h sensor;
+static bool accelerometer_running = false;
 
-// HR.
+// HR. The listeners belong to the tracking session: created for its first measurement,
+// only started and stopped per measurement, destroyed when tracking stops.
 static sensor_listener_h hr_listener;
 static sensor_h hr_sensor;
+static bool hr_listener_created = false;
+static sensor_listener_h ppg_listener;
+static sensor_h ppg_sensor;
+static bool ppg_listener_created = false;
+static bool ppg_running = false;
 
-static int batch_size = 1;
 // Version of application on phone (of the addon).
 static int addon_version = -1;
 
@@ -47,12 +113,46 @@ static int current_sum_count = 0;
 static float current_new_acti_max = 0;
 
 static gint64 paused_till = 0;
-
-// What pause state does UI see.
-static bool ui_pause_secs_remaining = 0;
+// Pause is entered on the phone's Pause command and left at paused_till by a one-shot timer,
+// or in epoch mode by the wall clock check of the first batch after it.
+static bool paused = false;
+// Milliseconds since epoch at which the current pause started.
+static gint64 pause_started_at = 0;
+// Epoch mode holds the CPU from the re-arm before the end of a pause until it ends.
+static bool pause_rearm_cpu_held = false;
+// Zero epochs of finished pauses that did not fit the motion buffer yet. They go in ahead of any
+// later epoch as room frees up, so a long pause rides on the regular batches instead of being dropped.
+static int pause_epochs_owed = 0;
 
 static bool hr_supported = false;
 
+// Degradation tiers from the system's low battery and low memory events, 0 is normal operation.
+// The battery tier only goes up, the system never tells us the battery recovered.
+typedef enum {
+	BATTERY_TIER_NORMAL,
+	BATTERY_TIER_LOW,
+	BATTERY_TIER_POWER_OFF,
+} battery_tier_e;
+
+typedef enum {
+	MEMORY_TIER_NORMAL,
+	MEMORY_TIER_SOFT,
+	MEMORY_TIER_HARD,
+} memory_tier_e;
+
+static battery_tier_e battery_tier = BATTERY_TIER_NORMAL;
+static memory_tier_e memory_tier = MEMORY_TIER_NORMAL;
+// The last mode change did not reach the phone yet.
+static bool mode_report_pending = false;
+
+static bool hr_allowed() {
+	return hr_enabled && battery_tier == BATTERY_TIER_NORMAL;
+}
+
+static unsigned int accelerometer_interval_ms() {
+	return battery_tier == BATTERY_TIER_NORMAL ? ACCEL_INTERVAL_MS : LOW_BATTERY_ACCEL_INTERVAL_MS;
+}
+
 typedef struct motion_data {
 	float min_sum;
 	float max_sum;
@@ -61,9 +161,83 @@ typedef struct motion_data {
 } motion_data_s;
 
 // Motion data to be send.
-static motion_data_s motion_buffer[300];
+static motion_data_s motion_buffer[MAX_BUFFER_LENGTH];
 // How many elements we have in the motion buffer.
 static int motion_buffer_size = 0;
+typedef struct hr_reading {
+	// Milliseconds since epoch at which the measurement started, same unit the phone uses for Pause.
+	gint64 timestamp;
+	float bpm;
+	float confidence;
+	// rr_count is 0 when the window had no usable beat to beat summary.
+	ppg_hrv_summary_s hrv;
+} hr_reading_s;
+
+// HR readings to be sent with the next motion batch.
+static hr_reading_s hr_buffer[MAX_HR_BUFFER_LENGTH];
+static int hr_buffer_size = 0;
+static int hr_readings_dropped = 0;
+
+typedef struct stage_entry {
+	// Milliseconds since epoch at which the scored minute started.
+	gint64 timestamp;
+	sleep_stage_e stage;
+} stage_entry_s;
+
+// Scored minutes to be sent with the next batch.
+static stage_entry_s stage_buffer[MAX_STAGE_BUFFER_LENGTH];
+static int stage_buffer_size = 0;
+// Latest scored minute, the scoring lags a few minutes behind the epochs.
+static stage_entry_s last_scored_minute = { 0, SLEEP_STAGE_UNKNOWN };
+
+typedef struct pause_entry {
+	gint64 start;
+	gint64 duration;
+} pause_entry_s;
+
+// Finished pauses to be sent with the next batch, in milliseconds.
+static pause_entry_s pause_buffer[MAX_PAUSE_BUFFER_LENGTH];
+static int pause_buffer_size = 0;
+static gint64 tracking_started_at = 0;
+
+// Last flush did not leave the watch, the buffer is kept and sent again once the link is writable.
+static bool flush_pending = false;
+
+// Send path counters for the current tracking session.
+static int sends_failed = 0;
+static int sends_retried = 0;
+static int epochs_dropped = 0;
+
+// When the command being handled arrived from the phone, for latency accounting.
+static double command_received_at = 0;
+
+static Eina_Bool send_motion_cb(void *data);
+static void check_smart_alarm(float max_sum);
+static void set_battery_tier(battery_tier_e tier);
+static void set_memory_tier(memory_tier_e tier);
+static void check_wall_deadlines();
+
+// In epoch mode the sensor hub wakes us with a batch once per epoch. Epochs are split by sensor timestamps,
+// a batch may straddle the boundary, and the CPU is held only while the finished epoch is processed and sent.
+static void close_epochs_until(unsigned long long timestamp) {
+	if (epoch_end_timestamp == 0) {
+		epoch_end_timestamp = timestamp + SAMPLING_TIME_SEC * 1000000ULL;
+		return;
+	}
+
+	while (timestamp >= epoch_end_timestamp) {
+		power_lock_cpu_acquire();
+		send_motion_cb(NULL);
+		check_wall_deadlines();
+		power_lock_cpu_release();
+		if (epoch_end_timestamp == 0) {
+			// The pause ended on this batch, the first epoch after it starts here instead of at 0.
+			epoch_end_timestamp = timestamp + SAMPLING_TIME_SEC * 1000000ULL;
+			break;
+		}
+		epoch_end_timestamp += SAMPLING_TIME_SEC * 1000000ULL;
+	}
+}
 
 //sensor event callback implementation
 static void sensor_event_callback(sensor_h sensor, sensor_event_s *event, void *user_data)
@@ -72,12 +246,16 @@ static void sensor_event_callback(sensor_h sensor, sensor_event_s *event, void *
     sensor_get_type(sensor, &type);
     if(type == SENSOR_ACCELEROMETER)
     {
+    	if (epoch_cpu_lock_active) {
+    		close_epochs_until(event->timestamp);
+    	}
+
         float x = event->values[0];
         float y = event->values[1];
         float z = event->values[2];
 
     	if (values_total > 0) {
-    		float sum = fabs(x - lastX) + fabs(y - lastY) + fabs(z - lastZ);
+    		float sum = (fabs(x - lastX) + fabs(y - lastY) + fabs(z - lastZ)) * ACCEL_INTERVAL_MS / accelerometer_interval_ms();
     		if (sum > current_max_sum) {
     			current_max_sum = sum;
     		}
@@ -103,45 +281,113 @@ static void sensor_event_callback(sensor_h sensor, sensor_event_s *event, void *
 static void start_hr();
 static void stop_hr();
 
-static Eina_Bool restart_hrm(void *data EINA_UNUSED) {
-	start_hr();
-	return ECORE_CALLBACK_CANCEL;
+static bool hr_running = false;
+static double hr_started_at = 0;
+// Wall time the LED went on, readings are stamped with it rather than with the moment the window closed.
+static gint64 hr_started_at_unix_ms = 0;
+// HR converged, the window is kept open for the beat to beat intervals.
+static bool hr_estimate_pending = false;
+static hr_estimate_s pending_hr_estimate;
+
+// HR measurement counters for the current tracking session.
+static int hr_measurements = 0;
+static int hr_converged = 0;
+static int hr_gave_up = 0;
+static double hr_on_sec = 0;
+
+static void record_hr_reading(const hr_estimate_s *estimate, const ppg_hrv_summary_s *hrv) {
+	const gint64 measured_at = hr_started_at_unix_ms;
+	state_page_add_hr(measured_at, estimate->bpm, estimate->confidence);
+
+	if (!hr_series) {
+		// Older addons only know the untimed reading, sent right away.
+		Eina_Strbuf *strbuf = eina_strbuf_new();
+		eina_strbuf_append_printf(strbuf, "%s%f", "HR_DATA", estimate->bpm);
+		char *txt = eina_strbuf_string_steal(strbuf);
+		eina_strbuf_free(strbuf);
+
+		send_data(txt);
+		free(txt);
+		return;
+	}
+
+	// The reading waits for the next motion batch, no wakeup of the radio for it alone.
+	if (hr_buffer_size == MAX_HR_BUFFER_LENGTH) {
+		memmove(hr_buffer, hr_buffer + 1, (MAX_HR_BUFFER_LENGTH - 1) * sizeof(hr_reading_s));
+		hr_buffer_size--;
+		hr_readings_dropped++;
+	}
+	hr_buffer[hr_buffer_size].timestamp = measured_at;
+	hr_buffer[hr_buffer_size].bpm = estimate->bpm;
+	hr_buffer[hr_buffer_size].confidence = estimate->confidence;
+	hr_buffer[hr_buffer_size].hrv = *hrv;
+	hr_buffer_size++;
 }
 
-float hrm_sum = 0;
-int hrm_values = 0;
+static void finish_hr_measurement(hr_estimate_status_e status, const hr_estimate_s *estimate) {
+	const bool had_ppg = ppg_running;
+	stop_hr();
+
+	if (status == HR_ESTIMATE_CONVERGED) {
+		hr_converged++;
+	} else {
+		hr_gave_up++;
+	}
+
+	dlog_print(DLOG_INFO, TAG, "HR %s: %.1f bpm, confidence %.2f, %d samples",
+			status == HR_ESTIMATE_CONVERGED ? "converged" : "gave up", estimate->bpm, estimate->confidence, estimate->samples);
+	if (estimate->samples > 0) {
+		ppg_hrv_summary_s hrv = { 0 };
+		if (had_ppg && !ppg_hrv_summary(&hrv)) {
+			hrv.rr_count = 0;
+		}
+		record_hr_reading(estimate, &hrv);
+	}
+}
+
+static void time_out_hr_measurement() {
+	hr_estimate_s estimate;
+
+	if (hr_estimate_pending) {
+		dlog_print(DLOG_INFO, TAG, "HRV window timed out with %d RR", ppg_hrv_rr_count());
+		estimate = pending_hr_estimate;
+		finish_hr_measurement(HR_ESTIMATE_CONVERGED, &estimate);
+		return;
+	}
+	dlog_print(DLOG_INFO, TAG, "HR measurement timed out");
+	finish_hr_measurement(hr_estimator_give_up(&estimate), &estimate);
+}
+
+static Eina_Bool hr_timeout_cb(void *data EINA_UNUSED) {
+	hr_timeout_timer = NULL;
+	time_out_hr_measurement();
+	return ECORE_CALLBACK_CANCEL;
+}
 
 static void hr_sensor_event_callback(sensor_h sensor, sensor_event_s *event, void *user_data) {
 	sensor_type_e type;
 	sensor_get_type(sensor, &type);
 	float hrm_value;
+	hr_estimate_s estimate;
 
 	switch (type) {
 		case SENSOR_HRM:
+			if (!hr_running || hr_estimate_pending) {
+				// Late event after the listener was stopped, or the HR is already known.
+				break;
+			}
 			hrm_value = event->values[0];
 			if (hrm_value != 0.0f) {
 				dlog_print(DLOG_INFO, TAG, "HRM: %f" , hrm_value);
 			}
-			if (hrm_value > 20.0f && hrm_value < 200.0f) {
-				// We got a real value.. let's sum them till we have 10 samples
-				hrm_sum += hrm_value;
-				hrm_values++;
-				if (hrm_values >= 10) {
-						// We have enough data -> Send it and let's measure again in 5 minutes.
-					hr_timer = ecore_timer_add(5 * 60, restart_hrm, NULL);
-
-					Eina_Strbuf *strbuf = eina_strbuf_new();
-					eina_strbuf_append_printf(strbuf, "%s%f", "HR_DATA", hrm_sum / hrm_values);
-					char *txt = eina_strbuf_string_steal(strbuf);
-					eina_strbuf_free(strbuf);
-
-					send_data(txt);
-					free(txt);
-
-					stop_hr();
-					hrm_values = 0;
-					hrm_sum = 0;
-				}
+			const hr_estimate_status_e status = hr_estimator_add(hrm_value, &estimate);
+			if (status == HR_ESTIMATE_CONVERGED && ppg_running && ppg_hrv_rr_count() < HRV_TARGET_RR) {
+				// The HR converges after a handful of samples, far too few beats for SDNN and RMSSD.
+				dlog_print(DLOG_INFO, TAG, "HR converged, keeping the PPG on for HRV (%d RR so far)", ppg_hrv_rr_count());
+				pending_hr_estimate = estimate;
+				hr_estimate_pending = true;
+			} else if (status != HR_ESTIMATE_PENDING) {
+				finish_hr_measurement(status, &estimate);
 			}
 			break;
 		default:
@@ -149,6 +395,17 @@ static void hr_sensor_event_callback(sensor_h sensor, sensor_event_s *event, voi
 	}
 }
 
+static void ppg_sensor_event_callback(sensor_h sensor, sensor_event_s *event, void *user_data) {
+	if (!ppg_running) {
+		return;
+	}
+	ppg_hrv_add(event->timestamp, event->values[0]);
+	if (hr_estimate_pending && ppg_hrv_rr_count() >= HRV_TARGET_RR) {
+		hr_estimate_s estimate = pending_hr_estimate;
+		finish_hr_measurement(HR_ESTIMATE_CONVERGED, &estimate);
+	}
+}
+
 static bool check_hr_supported() {
 	sensor_type_e type = SENSOR_HRM;
 
@@ -166,50 +423,172 @@ static bool check_hr_supported() {
 	return supported;
 }
 
-static void start_accelerometer() {
+// Returns true when the sensor hub accepted the requested batch latency (0 = no batching).
+static bool start_accelerometer(unsigned int max_batch_latency_ms) {
 	sensor_type_e type = SENSOR_ACCELEROMETER;
+	bool batched = false;
 
 	if (sensor_get_default_sensor(type, &sensor) == SENSOR_ERROR_NONE)
 	{
 	    if (sensor_create_listener(sensor, &listener) == SENSOR_ERROR_NONE
-	        && sensor_listener_set_event_cb(listener, 100, sensor_event_callback, NULL) == SENSOR_ERROR_NONE
+	        && sensor_listener_set_event_cb(listener, accelerometer_interval_ms(), sensor_event_callback, NULL) == SENSOR_ERROR_NONE
 	    	&& sensor_listener_set_option(listener, SENSOR_OPTION_ALWAYS_ON) == SENSOR_ERROR_NONE)
 	    {
+	    	if (max_batch_latency_ms > 0) {
+	    		int err = sensor_listener_set_max_batch_latency(listener, max_batch_latency_ms);
+	    		batched = err == SENSOR_ERROR_NONE;
+	    		if (!batched) {
+	    			dlog_print(DLOG_ERROR, TAG, "Sensor batching not available (%d)", err);
+	    		}
+	    	}
 	        if (sensor_listener_start(listener) == SENSOR_ERROR_NONE)
 	        {
+	        	accelerometer_running = true;
 	        	dlog_print(DLOG_INFO, TAG, "Sensor started");
 	        }
 	    }
 	}
+	return batched;
 }
 
 static void stop_accelerometer() {
+	if (!accelerometer_running) {
+		return;
+	}
+	accelerometer_running = false;
 	// TODO: Add error logging.
 	int err = sensor_listener_stop(listener);
 	err = sensor_destroy_listener(listener);
 }
 
-static void start_hr() {
-	sensor_type_e type = SENSOR_HRM;
+static bool create_hr_listener() {
+	if (hr_listener_created) {
+		return true;
+	}
 
-	if (sensor_get_default_sensor(type, &hr_sensor) == SENSOR_ERROR_NONE)
+	if (sensor_get_default_sensor(SENSOR_HRM, &hr_sensor) == SENSOR_ERROR_NONE
+		&& sensor_create_listener(hr_sensor, &hr_listener) == SENSOR_ERROR_NONE)
 	{
-	    if (sensor_create_listener(hr_sensor, &hr_listener) == SENSOR_ERROR_NONE
-	        && sensor_listener_set_event_cb(hr_listener, 100, hr_sensor_event_callback, NULL) == SENSOR_ERROR_NONE
+		if (sensor_listener_set_event_cb(hr_listener, 100, hr_sensor_event_callback, NULL) == SENSOR_ERROR_NONE
 			&& sensor_listener_set_option(hr_listener, SENSOR_OPTION_ALWAYS_ON) == SENSOR_ERROR_NONE)
-	    {
-	        if (sensor_listener_start(hr_listener) == SENSOR_ERROR_NONE)
-	        {
-	        	dlog_print(DLOG_INFO, TAG, "HR Sensor started");
-	        }
-	    }
+		{
+			hr_listener_created = true;
+			return true;
+		}
+		sensor_destroy_listener(hr_listener);
+	}
+	dlog_print(DLOG_ERROR, TAG, "Failed to create HR listener");
+	return false;
+}
+
+static bool create_ppg_listener() {
+	if (ppg_listener_created) {
+		return true;
+	}
+
+	bool supported = false;
+	if (sensor_is_supported(SENSOR_HRM_LED_GREEN, &supported) != SENSOR_ERROR_NONE || !supported) {
+		dlog_print(DLOG_INFO, TAG, "Green LED PPG not supported, no HRV");
+		return false;
+	}
+
+	if (sensor_get_default_sensor(SENSOR_HRM_LED_GREEN, &ppg_sensor) == SENSOR_ERROR_NONE
+		&& sensor_create_listener(ppg_sensor, &ppg_listener) == SENSOR_ERROR_NONE)
+	{
+		if (sensor_listener_set_event_cb(ppg_listener, PPG_INTERVAL_MS, ppg_sensor_event_callback, NULL) == SENSOR_ERROR_NONE
+			&& sensor_listener_set_option(ppg_listener, SENSOR_OPTION_ALWAYS_ON) == SENSOR_ERROR_NONE)
+		{
+			ppg_listener_created = true;
+			return true;
+		}
+		sensor_destroy_listener(ppg_listener);
+	}
+	dlog_print(DLOG_ERROR, TAG, "Failed to create PPG listener");
+	return false;
+}
+
+static void destroy_hr_listeners() {
+	if (hr_listener_created) {
+		sensor_destroy_listener(hr_listener);
+		hr_listener_created = false;
+	}
+	if (ppg_listener_created) {
+		sensor_destroy_listener(ppg_listener);
+		ppg_listener_created = false;
+	}
+}
+
+// The raw PPG stays on the watch, only the beat to beat summary of the window is sent.
+static void start_ppg() {
+	if (!create_ppg_listener()) {
+		return;
+	}
+
+	if (sensor_listener_start(ppg_listener) == SENSOR_ERROR_NONE) {
+		ppg_hrv_reset(1000.0f / PPG_INTERVAL_MS);
+		ppg_running = true;
+		dlog_print(DLOG_INFO, TAG, "PPG Sensor started");
+	} else {
+		dlog_print(DLOG_ERROR, TAG, "Failed to start PPG sensor");
+	}
+}
+
+static void stop_ppg() {
+	if (!ppg_running) {
+		return;
+	}
+	ppg_running = false;
+	sensor_listener_stop(ppg_listener);
+}
+
+static void start_hr() {
+	if (hr_running) {
+		return;
+	}
+	// Without a running sensor there is no LED to guard and nothing to time out.
+	if (!create_hr_listener() || sensor_listener_start(hr_listener) != SENSOR_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to start HR sensor");
+		return;
+	}
+	dlog_print(DLOG_INFO, TAG, "HR Sensor started");
+
+	hr_estimator_reset();
+	hr_running = true;
+	hr_estimate_pending = false;
+	hr_started_at = ecore_time_get();
+	hr_started_at_unix_ms = (gint64)(ecore_time_unix_get() * 1000);
+	hr_measurements++;
+	// In epoch mode the CPU would sleep between batches and take the timeout with it, the LED must not stay on.
+	power_lock_cpu_acquire();
+	hr_timeout_timer = scheduler_timer_add(HR_TIMEOUT_SEC, 0, hr_timeout_cb, NULL);
+
+	if (hrv_enabled && hr_series) {
+		start_ppg();
 	}
 }
 
 static void stop_hr() {
-	// TODO: Add error logging.
-	int err = sensor_listener_stop(hr_listener);
-	err = sensor_destroy_listener(hr_listener);
+	if (!hr_running) {
+		return;
+	}
+	const double sensor_on_sec = ecore_time_get() - hr_started_at;
+	hr_running = false;
+	hr_estimate_pending = false;
+	hr_on_sec += sensor_on_sec;
+	// Aborted measurements (pause, low battery, stop) had the LED on too and count against the budget.
+	hr_scheduler_on_measurement_done(sensor_on_sec);
+	power_lock_cpu_release();
+	if (hr_timeout_timer) {
+		scheduler_timer_del(hr_timeout_timer);
+		hr_timeout_timer = NULL;
+	}
+
+	stop_ppg();
+
+	if (hr_listener_created) {
+		// TODO: Add error logging.
+		int err = sensor_listener_stop(hr_listener);
+	}
 }
 
 static int pause_seconds_remaining() {
@@ -223,115 +602,433 @@ static int pause_seconds_remaining() {
 }
 
 static bool is_paused() {
-	return pause_seconds_remaining() > 0;
+	return paused;
 }
 
-static Eina_Bool send_motion_cb(void *data EINA_UNUSED) {
-	if (motion_buffer_size >= MAX_BUFFER_LENGTH -1) {
-		dlog_print(DLOG_ERROR, TAG, "Ignoring motion data, buffer full");
-		return ECORE_CALLBACK_RENEW;
+// Sections after the first one are separated by ';'.
+static void append_section(Eina_Strbuf *strbuf, const char *name) {
+	if (eina_strbuf_length_get(strbuf) > 0) {
+		eina_strbuf_append_printf(strbuf, ";");
 	}
+	eina_strbuf_append_printf(strbuf, "%s", name);
+}
 
-	if (is_paused()) {
-		current_min_sum = 0;
-		current_max_sum = 0;
-		current_total_sum = 0;
-		current_new_acti_max = 0;
+// Moves owed pause epochs into the motion buffer as far as there is room.
+static void queue_pause_epochs() {
+	const motion_data_s zero = { 0 };
+	while (pause_epochs_owed > 0 && motion_buffer_size < MAX_BUFFER_LENGTH - 1) {
+		motion_buffer[motion_buffer_size] = zero;
+		motion_buffer_size++;
+		pause_epochs_owed--;
 	}
+}
 
-	motion_buffer[motion_buffer_size].min_sum = current_min_sum;
-	motion_buffer[motion_buffer_size].max_sum = current_max_sum;
-	motion_buffer[motion_buffer_size].new_acti_max = current_new_acti_max;
-	if (current_sum_count > 0) {
-		motion_buffer[motion_buffer_size].avg_sum = current_total_sum / current_sum_count;
-	} else {
-		motion_buffer[motion_buffer_size].avg_sum = 0;
+// Sends everything in the motion buffer as one batch, queued HR readings are appended to the same message
+// as ";HR_SERIES" followed by timestamp,bpm,confidence triples, and their HRV summaries as ";HRV_SERIES"
+// followed by timestamp,mean_rr,sdnn,rmssd,rr_count. Scored minutes follow as ";STAGE_SERIES" with
+// timestamp,stage pairs, in summaries only mode they open the message. Pauses follow as ";PAUSE_SERIES"
+// with start,duration pairs. Buffers are only cleared when the batch left the watch.
+static bool flush_motion_buffer() {
+	if (motion_buffer_size == 0 && stage_buffer_size == 0 && pause_buffer_size == 0) {
+		flush_pending = false;
+		return true;
 	}
 
-	motion_buffer_size++;
-
-	dlog_print(DLOG_INFO, TAG, "Buffer size: %d Max sum: %f", motion_buffer_size, current_max_sum);
-
-	if (motion_buffer_size >= batch_size) {
-		Eina_Strbuf *strbuf = eina_strbuf_new();
+	Eina_Strbuf *strbuf = eina_strbuf_new();
+	if (motion_buffer_size > 0) {
+		append_section(strbuf, addon_version >= 1462 ? "NEW_ACTI_DATA" : "DATA");
+	}
+	for (int i = 0; i < motion_buffer_size; i++) {
+		if (i > 0) {
+			eina_strbuf_append_printf(strbuf, ",");
+		}
 		if (addon_version >= 1462) {
-			eina_strbuf_append_printf(strbuf, "%s", "NEW_ACTI_DATA");
+			eina_strbuf_append_printf(strbuf, "%f,%f,%f,%f", motion_buffer[i].max_sum, motion_buffer[i].min_sum, motion_buffer[i].avg_sum, motion_buffer[i].new_acti_max);
 		} else {
-			eina_strbuf_append_printf(strbuf, "%s", "DATA");
+			eina_strbuf_append_printf(strbuf, "%f,%f,%f", motion_buffer[i].max_sum, motion_buffer[i].min_sum, motion_buffer[i].avg_sum);
 		}
-		for (int i = 0; i < motion_buffer_size; i++) {
+	}
+	if (stage_buffer_size > 0) {
+		append_section(strbuf, "STAGE_SERIES");
+		for (int i = 0; i < stage_buffer_size; i++) {
 			if (i > 0) {
 				eina_strbuf_append_printf(strbuf, ",");
 			}
-			if (addon_version >= 1462) {
-				eina_strbuf_append_printf(strbuf, "%f,%f,%f,%f", motion_buffer[i].max_sum, motion_buffer[i].min_sum, motion_buffer[i].avg_sum, motion_buffer[i].new_acti_max);
+			eina_strbuf_append_printf(strbuf, "%lld,%d", stage_buffer[i].timestamp, stage_buffer[i].stage);
+		}
+	}
+	if (pause_buffer_size > 0) {
+		append_section(strbuf, "PAUSE_SERIES");
+		for (int i = 0; i < pause_buffer_size; i++) {
+			if (i > 0) {
+				eina_strbuf_append_printf(strbuf, ",");
+			}
+			eina_strbuf_append_printf(strbuf, "%lld,%lld", pause_buffer[i].start, pause_buffer[i].duration);
+		}
+	}
+	if (hr_buffer_size > 0) {
+		append_section(strbuf, "HR_SERIES");
+		for (int i = 0; i < hr_buffer_size; i++) {
+			if (i > 0) {
+				eina_strbuf_append_printf(strbuf, ",");
+			}
+			eina_strbuf_append_printf(strbuf, "%lld,%f,%f", hr_buffer[i].timestamp, hr_buffer[i].bpm, hr_buffer[i].confidence);
+		}
+		// Beat to beat summaries of the same readings, keyed by their timestamp.
+		bool first = true;
+		for (int i = 0; i < hr_buffer_size; i++) {
+			const ppg_hrv_summary_s *hrv = &hr_buffer[i].hrv;
+			if (hrv->rr_count == 0) {
+				continue;
+			}
+			if (first) {
+				append_section(strbuf, "HRV_SERIES");
 			} else {
-				eina_strbuf_append_printf(strbuf, "%f,%f,%f", motion_buffer[i].max_sum, motion_buffer[i].min_sum, motion_buffer[i].avg_sum);
+				eina_strbuf_append_printf(strbuf, ",");
 			}
+			eina_strbuf_append_printf(strbuf, "%lld,%f,%f,%f,%d", hr_buffer[i].timestamp,
+					hrv->mean_rr_ms, hrv->sdnn_ms, hrv->rmssd_ms, hrv->rr_count);
+			first = false;
 		}
+	}
 
-		char *txt = eina_strbuf_string_steal(strbuf);
-		eina_strbuf_free(strbuf);
-
-		send_data(txt);
-		free(txt);
+	char *txt = eina_strbuf_string_steal(strbuf);
+	eina_strbuf_free(strbuf);
 
-		motion_buffer_size = 0;
+	if (flush_pending) {
+		sends_retried++;
 	}
+	const send_result_e result = send_data(txt);
+	free(txt);
+
+	batch_controller_on_send_result(result == SEND_RESULT_OK);
+	if (result != SEND_RESULT_OK) {
+		sends_failed++;
+		flush_pending = true;
+		dlog_print(DLOG_ERROR, TAG, "Batch of %d kept for retry (result %d)", motion_buffer_size, result);
+		return false;
+	}
+
+	motion_buffer_size = 0;
+	stage_buffer_size = 0;
+	pause_buffer_size = 0;
+	hr_buffer_size = 0;
+	flush_pending = false;
+	// The rest of a long pause waits for the next batch.
+	queue_pause_epochs();
+	return true;
+}
 
+static void reset_epoch() {
 	current_min_sum = 10000;
 	current_max_sum = 0;
 	current_total_sum = 0;
 	current_sum_count = 0;
 	current_new_acti_max = 0;
+}
 
-	return ECORE_CALLBACK_RENEW;
+static void flush_if_batch_full() {
+	// A pending batch is retried on reconnect, or here once the socket is back but was busy.
+	const bool batch_full = summaries_only
+			? stage_buffer_size >= SUMMARY_BATCH_MINUTES
+			: motion_buffer_size >= batch_controller_get_size() || motion_buffer_size >= MAX_BUFFER_LENGTH - 1;
+	if (batch_full && (!flush_pending || is_connected())) {
+		flush_motion_buffer();
+	}
 }
 
-static void send_ui_command(const char* command);
+// Takes one finished epoch. Live epochs come from the sensor, the others stand in for a pause
+// and only keep the minute grid of the classifier going, their zero epochs are owed as a whole.
+static void add_epoch(const motion_data_s *epoch, bool live) {
+	if (!summaries_only && live) {
+		queue_pause_epochs();
+		if (motion_buffer_size >= MAX_BUFFER_LENGTH -1) {
+			epochs_dropped++;
+			dlog_print(DLOG_ERROR, TAG, "Ignoring motion data, buffer full");
+			return;
+		}
+		motion_buffer[motion_buffer_size] = *epoch;
+		motion_buffer_size++;
+	}
+
+	int minute;
+	sleep_stage_e stage;
+	const bool scored = sleep_classifier_add_epoch(epoch->max_sum, &minute, &stage);
+	if (scored) {
+		last_scored_minute.timestamp = tracking_started_at + minute * 60000LL;
+		last_scored_minute.stage = stage;
+	}
+	if (scored && (stage_codes || summaries_only)) {
+		if (stage_buffer_size == MAX_STAGE_BUFFER_LENGTH) {
+			memmove(stage_buffer, stage_buffer + 1, (MAX_STAGE_BUFFER_LENGTH - 1) * sizeof(stage_entry_s));
+			stage_buffer_size--;
+		}
+		stage_buffer[stage_buffer_size] = last_scored_minute;
+		stage_buffer_size++;
+	}
 
-static Eina_Bool update_ui_cb(void *data EINA_UNUSED) {
-	// Update pause state, if required.
-	const int pause_secs_remaining = pause_seconds_remaining();
-//	dlog_print(DLOG_INFO, TAG, "Pause sec: %d", pause_secs_remaining);
-	if (pause_secs_remaining != ui_pause_secs_remaining) {
-		ui_pause_secs_remaining = pause_secs_remaining;
+	if (live) {
+		state_page_set_last_epoch(epoch->max_sum, epoch->avg_sum);
+		dlog_print(DLOG_INFO, TAG, "Buffer size: %d Max sum: %f", motion_buffer_size, epoch->max_sum);
 
-		Eina_Strbuf *strbuf = eina_strbuf_new();
-		eina_strbuf_append_printf(strbuf, "pause_state:%d", pause_secs_remaining);
-		char *txt = eina_strbuf_string_steal(strbuf);
-		eina_strbuf_free(strbuf);
-		send_ui_command(txt);
-		free(txt);
+		check_smart_alarm(epoch->max_sum);
+
+		// HR starts ride on the epoch wakeup instead of a timer of their own.
+		if (hr_scheduler_on_epoch(epoch->max_sum) && hr_allowed()) {
+			start_hr();
+		}
+
+		flush_if_batch_full();
+	}
+}
+
+static Eina_Bool send_motion_cb(void *data EINA_UNUSED) {
+	// Only epoch mode gets here while paused, the sensor hub batches still mark the epochs.
+	// Nothing is sent for them, the pause is accounted for as a whole when it ends.
+	if (!is_paused()) {
+		motion_data_s epoch;
+		epoch.min_sum = current_min_sum;
+		epoch.max_sum = current_max_sum;
+		epoch.avg_sum = current_sum_count > 0 ? current_total_sum / current_sum_count : 0;
+		epoch.new_acti_max = current_new_acti_max;
+		add_epoch(&epoch, true);
 	}
 
+	reset_epoch();
 	return ECORE_CALLBACK_RENEW;
 }
 
+// The watchface learns till when we are paused (0 = not paused) from the state page and counts down on its own.
+static void publish_pause_state() {
+	state_page_set_paused_till(paused ? paused_till : 0);
+}
+
+// The accelerometer is off for the pause, without batching the epoch timer goes with it.
+static void suspend_sensors() {
+	stop_hr();
+	stop_accelerometer();
+	if (!epoch_cpu_lock_active) {
+		scheduler_timer_del(send_motion_timer);
+		send_motion_timer = NULL;
+	}
+}
+
+static Eina_Bool pause_expired_cb(void *data);
+
+// Starts the accelerometer shortly before the pause ends. In epoch mode the CPU was woken by the wake alarm for it
+// and is held from here to the end of the pause, the scheduler timers are on time again.
+static Eina_Bool pause_rearm_cb(void *data EINA_UNUSED) {
+	pause_rearm_timer = NULL;
+	if (accelerometer_running) {
+		return ECORE_CALLBACK_CANCEL;
+	}
 
+	if (!epoch_cpu_lock_active) {
+		start_accelerometer(0);
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	if (!pause_rearm_cpu_held) {
+		power_lock_cpu_acquire();
+		pause_rearm_cpu_held = true;
+	}
+	start_accelerometer(SAMPLING_TIME_SEC * 1000);
+	// The epochs before the accelerometer went off are long gone, the grid starts again with the first batch.
+	epoch_end_timestamp = 0;
+	// The monotonic clock stood still while we slept, the pause end is taken from the wall clock again.
+	if (pause_timer) {
+		scheduler_timer_del(pause_timer);
+	}
+	pause_timer = scheduler_timer_add(pause_seconds_remaining(), 0, pause_expired_cb, NULL);
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static void resume_sensors() {
+	if (!epoch_cpu_lock_active) {
+		pause_rearm_cb(NULL);
+		send_motion_timer = scheduler_timer_add(SAMPLING_TIME_SEC, 0, send_motion_cb, NULL);
+	} else {
+		if (!accelerometer_running) {
+			start_accelerometer(SAMPLING_TIME_SEC * 1000);
+		}
+		// The first epoch after the pause is a whole one, starting with the next sample.
+		epoch_end_timestamp = 0;
+	}
+	// Samples taken while re-arming only prime the deltas, the first epoch starts now.
+	reset_epoch();
+}
 
-static void start_tracking() {
+// Tells the phone about the finished pause, as a marker or as the zero epochs it used to get.
+static void account_pause(gint64 duration) {
+	if (pause_markers) {
+		if (pause_buffer_size == MAX_PAUSE_BUFFER_LENGTH) {
+			memmove(pause_buffer, pause_buffer + 1, (MAX_PAUSE_BUFFER_LENGTH - 1) * sizeof(pause_entry_s));
+			pause_buffer_size--;
+		}
+		pause_buffer[pause_buffer_size].start = pause_started_at;
+		pause_buffer[pause_buffer_size].duration = duration;
+		pause_buffer_size++;
+	}
+
+	const motion_data_s zero = { 0 };
+	const int epochs = duration / (SAMPLING_TIME_SEC * 1000);
+	for (int i = 0; i < epochs; i++) {
+		add_epoch(&zero, false);
+	}
+	if (!summaries_only && !pause_markers) {
+		pause_epochs_owed += epochs;
+		queue_pause_epochs();
+	}
+	// One send for the whole pause, not one per batch worth of zero epochs.
+	flush_if_batch_full();
+	dlog_print(DLOG_INFO, TAG, "Pause of %lld ms accounted as %d epochs%s, %d waiting for room",
+			duration, epochs, pause_markers ? " and a marker" : "", pause_epochs_owed);
+}
+
+static void end_pause() {
+	if (pause_timer) {
+		scheduler_timer_del(pause_timer);
+		pause_timer = NULL;
+	}
+	if (pause_rearm_timer) {
+		scheduler_timer_del(pause_rearm_timer);
+		pause_rearm_timer = NULL;
+	}
+	wake_alarm_cancel(WAKE_ALARM_PAUSE_REARM);
+	if (pause_rearm_cpu_held) {
+		power_lock_cpu_release();
+		pause_rearm_cpu_held = false;
+	}
+	if (!paused) {
+		return;
+	}
+	paused = false;
+	dlog_print(DLOG_INFO, TAG, "Pause finished");
+	publish_pause_state();
+
+	if (is_tracking) {
+		account_pause((gint64)(ecore_time_unix_get() * 1000) - pause_started_at);
+		resume_sensors();
+	}
+}
+
+static Eina_Bool pause_expired_cb(void *data EINA_UNUSED) {
+	pause_timer = NULL;
+	end_pause();
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static void update_pause() {
+	const int secs_remaining = pause_seconds_remaining();
+	if (!is_tracking || secs_remaining == 0) {
+		end_pause();
+		return;
+	}
+
+	if (!paused) {
+		pause_started_at = (gint64)(ecore_time_unix_get() * 1000);
+		suspend_sensors();
+	}
+
+	if (pause_timer) {
+		scheduler_timer_del(pause_timer);
+	}
+	if (pause_rearm_timer) {
+		scheduler_timer_del(pause_rearm_timer);
+		pause_rearm_timer = NULL;
+	}
+	// The epoch timer is gone with the sensors in timer mode, resuming must not wait for a wakeup to share.
+	pause_timer = scheduler_timer_add(secs_remaining, epoch_cpu_lock_active ? EPOCH_SLACK_SEC : 0, pause_expired_cb, NULL);
+	if (secs_remaining <= PAUSE_REARM_SEC) {
+		pause_rearm_cb(NULL);
+	} else if (!epoch_cpu_lock_active) {
+		// The pause may have got longer after the sensors were already re-armed.
+		stop_accelerometer();
+		pause_rearm_timer = scheduler_timer_add(secs_remaining - PAUSE_REARM_SEC, 0, pause_rearm_cb, NULL);
+	} else {
+		if (pause_rearm_cpu_held) {
+			power_lock_cpu_release();
+			pause_rearm_cpu_held = false;
+		}
+		if (wake_alarm_set(WAKE_ALARM_PAUSE_REARM, (paused_till - PAUSE_REARM_SEC) * 1000LL)) {
+			// Nothing wakes the CPU while the accelerometer is off, the wake alarm brings it up for the re-arm.
+			stop_accelerometer();
+		} else if (!accelerometer_running) {
+			// Without a wake alarm the batches are the only wakeup, check_wall_deadlines ends the pause on one of them.
+			start_accelerometer(SAMPLING_TIME_SEC * 1000);
+		}
+	}
+
+	// Moving an already running pause is a transition too, the watchface needs the new end.
+	paused = true;
+	dlog_print(DLOG_INFO, TAG, "Paused for %d sec", secs_remaining);
+	publish_pause_state();
+}
+
+
+
+// Returns false when tracking could not start, the watchface is told either way through the state page.
+static bool start_tracking() {
 	dlog_print(DLOG_INFO, TAG, "Starting tracking");
 	if (is_tracking) {
 		dlog_print(DLOG_INFO, TAG, "Duplicate start called");
-		return;
+		state_page_answer_start(TRUE);
+		return true;
 	}
 	setenv("LC_NUMBERS", "en_US.utf8", 1);
 	elm_language_set("en_US.utf8");
 
-	device_power_request_lock(POWER_LOCK_CPU, 0);
 	is_tracking = true;
 	paused_till = 0;
-	start_accelerometer();
-	send_motion_timer = ecore_timer_add(SAMPLING_TIME_SEC, send_motion_cb, NULL);
-	update_ui_timer = ecore_timer_add(1, update_ui_cb, NULL);
+	batch_controller_reset();
+	flush_pending = false;
+	sends_failed = 0;
+	sends_retried = 0;
+	epochs_dropped = 0;
+	scheduler_reset_stats();
+	power_lock_reset_stats();
+	hr_measurements = 0;
+	hr_converged = 0;
+	hr_gave_up = 0;
+	hr_on_sec = 0;
+	hr_buffer_size = 0;
+	hr_readings_dropped = 0;
+	stage_buffer_size = 0;
+	pause_epochs_owed = 0;
+	last_scored_minute.timestamp = 0;
+	last_scored_minute.stage = SLEEP_STAGE_UNKNOWN;
+	pause_buffer_size = 0;
+	tracking_started_at = (gint64)(ecore_time_unix_get() * 1000);
+	sleep_classifier_reset(SAMPLING_TIME_SEC);
+	hr_scheduler_reset(SAMPLING_TIME_SEC);
+	epoch_end_timestamp = 0;
+	epoch_cpu_lock_active = start_accelerometer(epoch_cpu_lock ? SAMPLING_TIME_SEC * 1000 : 0);
+	if (!accelerometer_running) {
+		// Nothing to track without motion, nothing was taken yet either.
+		dlog_print(DLOG_ERROR, TAG, "Accelerometer did not start, tracking rejected");
+		is_tracking = false;
+		state_page_answer_start(FALSE);
+		return false;
+	}
+	if (epoch_cpu_lock_active) {
+		dlog_print(DLOG_INFO, TAG, "Holding CPU lock per epoch only");
+	} else {
+		// Without batching nothing can wake us for the next epoch, keep the CPU up the whole night.
+		power_lock_cpu_acquire();
+		send_motion_timer = scheduler_timer_add(SAMPLING_TIME_SEC, 0, send_motion_cb, NULL);
+	}
+
+	// Alarms and hints during the night must not wait for the vibrator to open.
+	haptic_pattern_reset_stats();
+	haptic_pattern_set_warm(memory_tier == MEMORY_TIER_NORMAL);
 
-	if (hr_enabled) {
+	if (hr_allowed()) {
 		start_hr();
 	}
 
-	send_ui_command("tracking_on");
-
+	state_page_set_tracking(TRUE);
+	state_page_answer_start(TRUE);
+	return true;
 }
 
 static void stop_tracking() {
@@ -344,122 +1041,159 @@ static void stop_tracking() {
 	is_tracking = false;
 	stop_accelerometer();
 	stop_hr();
-	device_power_release_lock(POWER_LOCK_CPU);
-	ecore_timer_del(send_motion_timer);
-	ecore_timer_del(update_ui_timer);
-	if (hr_timer) {
-		ecore_timer_del(hr_timer);
-		hr_timer = NULL;
+	destroy_hr_listeners();
+	haptic_pattern_set_warm(FALSE);
+	if (!epoch_cpu_lock_active) {
+		power_lock_cpu_release();
 	}
-
-	send_ui_command("tracking_off");
-
-}
-
-static void send_ui_command(const char* command) {
-    app_control_h app_control;
-	if (app_control_create(&app_control) == APP_CONTROL_ERROR_NONE) {
-		int res1 = 0, res2 = 0, res3 = 0;
-		if (((res1 = app_control_set_app_id(app_control, "com.urbandroid.sleep.gearfit.watchface")) == APP_CONTROL_ERROR_NONE)
-			&& ((res2 = app_control_add_extra_data(app_control, "app_action", command)) == APP_CONTROL_ERROR_NONE)
-			&& ((res3 = app_control_send_launch_request(app_control, NULL, NULL)) == APP_CONTROL_ERROR_NONE)) {
-			dlog_print(DLOG_INFO, TAG, "Service: App command request sent: %s", command);
-		} else {
-			dlog_print(DLOG_ERROR, TAG, "Service: App command request sending failed! Err: %d %d %d", res1, res2, res3);
-		}
-		if (app_control_destroy(app_control) == APP_CONTROL_ERROR_NONE) {
-			dlog_print(DLOG_INFO, TAG, "Service: App control destroyed.");
+	scheduler_timer_del(send_motion_timer);
+	send_motion_timer = NULL;
+	end_pause();
+	batch_controller_log_stats();
+	haptic_pattern_log_stats();
+	sleep_classifier_log_stats();
+	scheduler_log_stats();
+	power_lock_log_stats();
+	dlog_print(DLOG_INFO, TAG, "Send stats: failed %d, retried %d, dropped epochs %d, still queued %d",
+			sends_failed, sends_retried, epochs_dropped, motion_buffer_size + pause_epochs_owed);
+	if (hr_measurements > 0) {
+		dlog_print(DLOG_INFO, TAG, "HR stats: %d measurements, %d converged, %d gave up, sensor on %.0f s (%.1f s per measurement)",
+				hr_measurements, hr_converged, hr_gave_up, hr_on_sec, hr_on_sec / hr_measurements);
+		hr_scheduler_log_stats();
+		if (hr_series) {
+			dlog_print(DLOG_INFO, TAG, "HR series: %d readings still queued, %d dropped", hr_buffer_size, hr_readings_dropped);
 		}
-	} else {
-		dlog_print(DLOG_ERROR, TAG, "Service: App control creation failed!");
 	}
+
+	state_page_set_tracking(FALSE);
+
 }
 
 static void stop_ui() {
 	dlog_print(DLOG_INFO, TAG, "Going to stop UI.");
-	send_ui_command("stop");
+	ui_channel_send(UI_MESSAGE_EVENT, "stop");
 }
 
-static haptic_device_h haptic_handle;
-
-static Eina_Bool vibrate_one_sec_for_hint(void *data) {
-	haptic_effect_h effect_handle;
-	int repeat = *((int*)data);
-	dlog_print(DLOG_INFO, TAG, "Repeates for vibrate: %d.", repeat);
-	if (repeat == 0) {
-		// Hint looping finished
-		device_haptic_close(haptic_handle);
-		if (hint_timer) {
-			// ecore_timer_del(hint_timer);  Do we need to delete the handle explicitly?
-		}
-		return ECORE_CALLBACK_CANCEL;
-	}
-
-	if (device_haptic_vibrate(haptic_handle, 1000, 100, &effect_handle) != DEVICE_ERROR_NONE) {
-		dlog_print(DLOG_ERROR, TAG, "Failed to vibrate");
+// Vibration goes first, the screen and the watchface can follow.
+static void start_alarm(int alarm_delay, double requested_at) {
+	if (alarm_delay > 0) {
+		// A phone StartAlarm after an alarm the watch fired itself leaves the crescendo where it is.
+		haptic_pattern_play(HAPTIC_PATTERN_ALARM, 0, alarm_delay / 1000.0, requested_at);
 	}
 
-	*((int*)data) = repeat - 1;
-	return ECORE_CALLBACK_RENEW;
+        device_power_request_lock(POWER_LOCK_DISPLAY, 0);
+	state_page_set_alarm_active(TRUE);
+	ui_channel_send(UI_MESSAGE_ALARM, "alarm_started");
 }
 
-static Eina_Bool vibrate_one_sec(void *data) {
-	haptic_effect_h effect_handle;
-	if (device_haptic_vibrate(haptic_handle, 1000, 100, &effect_handle) != DEVICE_ERROR_NONE) {
-		dlog_print(DLOG_ERROR, TAG, "Failed to vibrate");
-	}
+static void stop_alarm() {
+	state_page_set_alarm_active(FALSE);
+	ui_channel_send(UI_MESSAGE_ALARM, "alarm_finished");
+	haptic_pattern_stop(HAPTIC_PATTERN_ALARM);
 
-	return ECORE_CALLBACK_RENEW;
+	device_power_release_lock(POWER_LOCK_DISPLAY);
+
+	// If not tracking, we close the app after alarm is done.
+	if (!is_tracking) {
+//		stop_ui(); we don't do this in Gear Fit 2 watchface...
+		service_app_exit();
+	}
 }
 
-static void start_alarm(int alarm_delay) {
-        device_power_request_lock(POWER_LOCK_DISPLAY, 0);
-	send_ui_command("alarm_started");
+// Text for the phone about an alarm the watch fired itself, kept until it could be sent.
+static char *smart_alarm_notice = NULL;
 
-	if(device_haptic_open(0, &haptic_handle) != DEVICE_ERROR_NONE) {
-		dlog_print(DLOG_ERROR, TAG, "Failed to get vibrator!");
+static void send_smart_alarm_notice() {
+	if (smart_alarm_notice && send_data(smart_alarm_notice) == SEND_RESULT_OK) {
+		free(smart_alarm_notice);
+		smart_alarm_notice = NULL;
 	}
+}
 
-	if (alarm_delay > 0) {
-		alarm_timer = ecore_timer_add(2, vibrate_one_sec, NULL);
-		ecore_timer_delay(alarm_timer, alarm_delay / 1000);
+static void cancel_smart_alarm() {
+	smart_alarm_clear();
+	wake_alarm_cancel(WAKE_ALARM_SMART_ALARM);
+	if (smart_alarm_timer) {
+		scheduler_timer_del(smart_alarm_timer);
+		smart_alarm_timer = NULL;
 	}
 }
 
-static void stop_alarm() {
-	send_ui_command("alarm_finished");
-	if (alarm_timer) {
-		ecore_timer_del(alarm_timer);
-	}
+static void fire_smart_alarm(smart_alarm_trigger_e trigger) {
+	const gint64 now = (gint64)(ecore_time_unix_get() * 1000);
+	dlog_print(DLOG_INFO, TAG, "Smart alarm fired on %s, %lld ms before the deadline",
+			smart_alarm_trigger_name(trigger), smart_alarm_latest() - now);
+	cancel_smart_alarm();
+	start_alarm(LOCAL_ALARM_DELAY_MS, ecore_time_get());
+
+	Eina_Strbuf *strbuf = eina_strbuf_new();
+	eina_strbuf_append_printf(strbuf, "SMART_ALARM;%lld;%s", now, smart_alarm_trigger_name(trigger));
+	free(smart_alarm_notice);
+	smart_alarm_notice = eina_strbuf_string_steal(strbuf);
+	eina_strbuf_free(strbuf);
+	send_smart_alarm_notice();
+}
 
-	device_haptic_close(haptic_handle);
+static void check_smart_alarm(float max_sum) {
+	const smart_alarm_trigger_e trigger = smart_alarm_on_epoch((gint64)(ecore_time_unix_get() * 1000),
+			max_sum, last_scored_minute.stage, last_scored_minute.timestamp);
+	if (trigger != SMART_ALARM_NONE) {
+		fire_smart_alarm(trigger);
+	}
+}
 
-	device_power_release_lock(POWER_LOCK_DISPLAY);
+// Fires at the latest time of the window whether or not an epoch or the phone got there first,
+// as long as the CPU is awake. While it sleeps the wake alarm set with the window brings it up.
+static Eina_Bool smart_alarm_deadline_cb(void *data EINA_UNUSED) {
+	smart_alarm_timer = NULL;
+	fire_smart_alarm(SMART_ALARM_DEADLINE);
+	return ECORE_CALLBACK_CANCEL;
+}
 
-	// If not tracking, we close the app after alarm is done.
-	if (!is_tracking) {
-//		stop_ui(); we don't do this in Gear Fit 2 watchface...
-		service_app_exit();
+static void set_smart_alarm(gint64 earliest, gint64 latest, int sensitivity) {
+	cancel_smart_alarm();
+	const gint64 now = (gint64)(ecore_time_unix_get() * 1000);
+	if (latest <= now) {
+		dlog_print(DLOG_INFO, TAG, "Smart alarm window cancelled or already over");
+		return;
+	}
+	if (smart_alarm_set(earliest, latest, sensitivity)) {
+		smart_alarm_timer = scheduler_timer_add((latest - now) / 1000.0, 0, smart_alarm_deadline_cb, NULL);
+		// Paused, or asleep between epoch batches, nothing else would be awake at the deadline.
+		wake_alarm_set(WAKE_ALARM_SMART_ALARM, latest);
 	}
 }
 
-static int hint_repeats = 0;
-static void hint(int repeat) {
-	if(device_haptic_open(0, &haptic_handle) != DEVICE_ERROR_NONE) {
-		dlog_print(DLOG_ERROR, TAG, "Failed to get vibrator!");
+// Scheduler timers run on the monotonic clock, which stands still while the CPU sleeps between epoch batches.
+// Every batch wakeup therefore also checks the deadlines against the wall clock, paused epochs included.
+static void check_wall_deadlines() {
+	const gint64 now = (gint64)(ecore_time_unix_get() * 1000);
+
+	if (paused && pause_seconds_remaining() == 0) {
+		end_pause();
 	}
+	if (hr_running && now - hr_started_at_unix_ms >= HR_TIMEOUT_SEC * 1000LL) {
+		time_out_hr_measurement();
+	}
+	if (smart_alarm_is_armed() && now >= smart_alarm_latest()) {
+		fire_smart_alarm(SMART_ALARM_DEADLINE);
+	}
+}
 
-	hint_repeats = repeat;
-	dlog_print(DLOG_DEBUG, TAG, "Going to vibrate one sec for hint");
-	hint_timer = ecore_timer_add(2, vibrate_one_sec_for_hint, &hint_repeats);
+static void hint(int repeat) {
+	dlog_print(DLOG_DEBUG, TAG, "Going to vibrate %d times for hint", repeat);
+	haptic_pattern_play(HAPTIC_PATTERN_HINT, repeat, 0, command_received_at);
 }
 
 static void handle_data_received(unsigned int payload_length, void *buffer) {
 	const char* data = (const char*)buffer;
+	command_received_at = ecore_time_get();
 	dlog_print(DLOG_INFO, TAG, "Received command %s", data);
+	batch_controller_on_phone_activity();
 	if (eina_str_has_prefix(data, "StartTracking")) {
-		start_tracking();
-		send_ui_command("tracking_started");
+		if (start_tracking()) {
+			ui_channel_send(UI_MESSAGE_EVENT, "tracking_started");
+		}
 	} else if (eina_str_has_prefix(data, "AppVersion")) {
 		unsigned int num_elements = 0;
 		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
@@ -483,6 +1217,66 @@ static void handle_data_received(unsigned int payload_length, void *buffer) {
 			free(split_data[0]);
 		}
 		free(split_data);
+	} else if (eina_str_has_prefix(data, "HrSeries")) {
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
+		hr_series = false;
+		if (num_elements == 2) {
+			hr_series = eina_str_has_prefix(split_data[1], "true");
+		}
+		dlog_print(DLOG_INFO, TAG, "HR series: %d", hr_series);
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
+	} else if (eina_str_has_prefix(data, "Hrv")) {
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
+		hrv_enabled = false;
+		if (num_elements == 2) {
+			hrv_enabled = eina_str_has_prefix(split_data[1], "true");
+		}
+		dlog_print(DLOG_INFO, TAG, "HRV enabled: %d", hrv_enabled);
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
+	} else if (eina_str_has_prefix(data, "StageCodes")) {
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
+		stage_codes = false;
+		if (num_elements == 2) {
+			stage_codes = eina_str_has_prefix(split_data[1], "true");
+		}
+		dlog_print(DLOG_INFO, TAG, "Stage codes: %d", stage_codes);
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
+	} else if (eina_str_has_prefix(data, "SummariesOnly")) {
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
+		summaries_only = false;
+		if (num_elements == 2) {
+			summaries_only = eina_str_has_prefix(split_data[1], "true");
+		}
+		dlog_print(DLOG_INFO, TAG, "Summaries only: %d", summaries_only);
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
+	} else if (eina_str_has_prefix(data, "EpochCpuLock")) {
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
+		epoch_cpu_lock = false;
+		if (num_elements == 2) {
+			epoch_cpu_lock = eina_str_has_prefix(split_data[1], "true");
+		}
+		dlog_print(DLOG_INFO, TAG, "Epoch CPU lock: %d", epoch_cpu_lock);
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
 	} else if (eina_str_has_prefix(data, "StopApp")) {
 		stop_tracking();
 		stop_alarm();
@@ -491,19 +1285,33 @@ static void handle_data_received(unsigned int payload_length, void *buffer) {
 		unsigned int num_elements = 0;
 		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
 		if (num_elements == 2) {
-			batch_size = atoi(split_data[1]);
+			int batch_size = atoi(split_data[1]);
 			dlog_print(DLOG_INFO, TAG, "Setting batch size: %d", batch_size);
+			batch_controller_set_ceiling(batch_size);
 		}
 		if (num_elements > 0) {
 			free(split_data[0]);
 		}
 		free(split_data);
+	} else if (eina_str_has_prefix(data, "PauseMarker")) {
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
+		pause_markers = false;
+		if (num_elements == 2) {
+			pause_markers = eina_str_has_prefix(split_data[1], "true");
+		}
+		dlog_print(DLOG_INFO, TAG, "Pause markers: %d", pause_markers);
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
 	} else if (eina_str_has_prefix(data, "Pause")) {
 		unsigned int num_elements = 0;
 		char** split_data = eina_str_split_full(data, ";", 2, &num_elements);
 		if (num_elements == 2) {
 			paused_till = atoll(split_data[1]) / 1000;  // MS to Sec
 			dlog_print(DLOG_INFO, TAG, "Setting paused till: %lld (%s)", paused_till, split_data[1]);
+			update_pause();
 		}
 		if (num_elements > 0) {
 			free(split_data[0]);
@@ -515,7 +1323,40 @@ static void handle_data_received(unsigned int payload_length, void *buffer) {
 		if (num_elements == 2) {
 			int alarm_delay = atoi(split_data[1]);
 			dlog_print(DLOG_INFO, TAG, "Starting alarm with delay %d", alarm_delay);
-			start_alarm(alarm_delay);
+			start_alarm(alarm_delay, command_received_at);
+		}
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
+	} else if (eina_str_has_prefix(data, "SmartAlarmWindow")) {
+		// SmartAlarmWindow;earliest;latest;sensitivity, times in ms. A window in the past cancels.
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 4, &num_elements);
+		if (num_elements == 4) {
+			set_smart_alarm(atoll(split_data[1]), atoll(split_data[2]), atoi(split_data[3]));
+		} else {
+			cancel_smart_alarm();
+		}
+		if (num_elements > 0) {
+			free(split_data[0]);
+		}
+		free(split_data);
+	} else if (eina_str_has_prefix(data, "SimulatePower")) {
+		// SimulatePower;battery tier;memory tier, raises the degradation the system events would.
+		// The battery tier still only goes up.
+		unsigned int num_elements = 0;
+		char** split_data = eina_str_split_full(data, ";", 3, &num_elements);
+		if (num_elements == 3) {
+			const int battery = atoi(split_data[1]);
+			const int memory = atoi(split_data[2]);
+			dlog_print(DLOG_INFO, TAG, "Simulating battery tier %d, memory tier %d", battery, memory);
+			if (battery >= BATTERY_TIER_NORMAL && battery <= BATTERY_TIER_POWER_OFF) {
+				set_battery_tier(battery);
+			}
+			if (memory >= MEMORY_TIER_NORMAL && memory <= MEMORY_TIER_HARD) {
+				set_memory_tier(memory);
+			}
 		}
 		if (num_elements > 0) {
 			free(split_data[0]);
@@ -540,47 +1381,175 @@ static void handle_data_received(unsigned int payload_length, void *buffer) {
 	}
 }
 
+static void report_mode() {
+	Eina_Strbuf *strbuf = eina_strbuf_new();
+	eina_strbuf_append_printf(strbuf, "POWER_MODE;%d;%d", battery_tier, memory_tier);
+	char *txt = eina_strbuf_string_steal(strbuf);
+	eina_strbuf_free(strbuf);
+
+	mode_report_pending = send_data(txt) != SEND_RESULT_OK;
+	free(txt);
+}
+
+// Applies the current battery and memory tiers to everything that can be degraded.
+static void apply_degradation() {
+	dlog_print(DLOG_INFO, TAG, "Degradation: battery tier %d, memory tier %d", battery_tier, memory_tier);
+
+	if (battery_tier != BATTERY_TIER_NORMAL) {
+		// A radio wakeup per epoch would cost more than a batch held in memory, low memory
+		// on top of it is served by the flush below and keeps the large batch.
+		batch_controller_set_override(LOW_BATTERY_BATCH_SIZE);
+	} else {
+		batch_controller_set_override(memory_tier != MEMORY_TIER_NORMAL ? LOW_MEMORY_BATCH_SIZE : 0);
+	}
+
+	if (battery_tier != BATTERY_TIER_NORMAL) {
+		// HR is the biggest drain we control, the alarm matters more.
+		stop_hr();
+		// The battery tier never goes back down, the stretched interval stays for the rest of the run.
+		if (accelerometer_running) {
+			const int err = sensor_listener_set_interval(listener, accelerometer_interval_ms());
+			if (err != SENSOR_ERROR_NONE) {
+				dlog_print(DLOG_ERROR, TAG, "Failed to set accelerometer interval (%d)", err);
+			}
+		}
+	}
+
+	if (memory_tier == MEMORY_TIER_HARD) {
+		// Give back what can be opened again later.
+		haptic_pattern_set_warm(FALSE);
+		if (!hr_running) {
+			destroy_hr_listeners();
+		}
+		// The buffers are static, what shrinks is the heap the batch strings and closed handles left behind.
+		malloc_trim(0);
+	} else if (memory_tier == MEMORY_TIER_NORMAL && is_tracking) {
+		haptic_pattern_set_warm(TRUE);
+	}
+
+	// Queued data is memory we hold and data we lose if the battery dies, get it out now.
+	if (is_tracking && (memory_tier != MEMORY_TIER_NORMAL || battery_tier == BATTERY_TIER_POWER_OFF)
+			&& (!flush_pending || is_connected())) {
+		flush_motion_buffer();
+	}
+
+	report_mode();
+}
+
+static void set_battery_tier(battery_tier_e tier) {
+	if (tier <= battery_tier) {
+		return;
+	}
+	battery_tier = tier;
+	apply_degradation();
+}
+
+static void set_memory_tier(memory_tier_e tier) {
+	if (tier == memory_tier) {
+		return;
+	}
+	memory_tier = tier;
+	apply_degradation();
+}
+
+static void handle_connection_changed(gboolean connected) {
+	dlog_print(DLOG_INFO, TAG, "Connection %s", connected ? "up" : "down");
+	state_page_set_link(connected);
+	if (connected) {
+		send_smart_alarm_notice();
+		if (mode_report_pending) {
+			report_mode();
+		}
+	}
+	if (connected && is_tracking) {
+		batch_controller_on_reconnect();
+		if (flush_pending) {
+			flush_motion_buffer();
+		}
+	}
+}
+
+// Commands from the watchface, delivered over the message port or as a launch request.
+static void handle_ui_action(const char *action) {
+	if (strcmp(action, "start_tracking") == 0) {
+		start_tracking();
+	} else if (strcmp(action, "pause") == 0) {
+		send_data("PAUSE");
+	} else if (strcmp(action, "resume") == 0) {
+		send_data("RESUME");
+	} else if (strcmp(action, "snooze") == 0) {
+		send_data("SNOOZE");
+	} else if (strcmp(action, "dismiss") == 0) {
+		send_data("DISMISS");
+	} else if (strcmp(action, "terminate") == 0) {
+		send_data("STOP");
+		service_app_exit();
+	} else {
+		dlog_print(DLOG_INFO, LOG_TAG, "Service: Unsupported action! Doing nothing...");
+	}
+}
+
+static void handle_wake_alarm(wake_alarm_e alarm) {
+	dlog_print(DLOG_INFO, TAG, "Woken by wake alarm %d", alarm);
+	switch (alarm) {
+		case WAKE_ALARM_SMART_ALARM:
+			// The alarm stands for the deadline, no need to compare clocks that may disagree by a second.
+			if (smart_alarm_is_armed()) {
+				fire_smart_alarm(SMART_ALARM_DEADLINE);
+			}
+			break;
+		case WAKE_ALARM_PAUSE_REARM:
+			if (paused && is_tracking) {
+				pause_rearm_cb(NULL);
+			}
+			break;
+		default:
+			break;
+	}
+	check_wall_deadlines();
+}
+
 bool service_app_create(void *data) {
 	dlog_print(DLOG_INFO, TAG, "Service started");
-	initialize_sap(handle_data_received);
+	state_page_open();
+	ui_channel_init(handle_ui_action);
+	initialize_sap(handle_data_received, handle_connection_changed);
 	dlog_print(DLOG_INFO, TAG, "SAP initialized");
     return true;
 }
 
 void service_app_terminate(void *data) {
 	terminate_sap();
+	ui_channel_shutdown();
+	state_page_close();
     return;
 }
 
 void service_app_control(app_control_h app_control, void *data) {
 	dlog_print(DLOG_INFO, LOG_TAG, "Service: App control received");
+	wake_alarm_e wake_alarm;
+	if (wake_alarm_from_app_control(app_control, &wake_alarm)) {
+		handle_wake_alarm(wake_alarm);
+		return;
+	}
+
 	char *caller_id = NULL;
 	if (app_control_get_caller(app_control, &caller_id) == APP_CONTROL_ERROR_NONE) {
 		dlog_print(DLOG_INFO, LOG_TAG, "Service: Caller: %s", caller_id);
 		free(caller_id);
 	}
 	char *action_value = NULL;
-    if (app_control_get_extra_data(app_control, "app_action", &action_value) == APP_CONTROL_ERROR_NONE) {
+    if (app_control_get_extra_data(app_control, KEY_ACTION, &action_value) == APP_CONTROL_ERROR_NONE && action_value != NULL) {
     	dlog_print(DLOG_INFO, LOG_TAG, "Service: App control action: %s", action_value);
 
-    	// Add start?
-    	if (action_value != NULL && strcmp(action_value, "start_tracking") == 0) {
-    		start_tracking();
-		} else if (action_value != NULL && strcmp(action_value, "pause") == 0) {
-			send_data("PAUSE");
-		} else if (action_value != NULL && strcmp(action_value, "resume") == 0) {
-			send_data("RESUME");
-		} else if (action_value != NULL && strcmp(action_value, "snooze") == 0) {
-			send_data("SNOOZE");
-		} else if (action_value != NULL && strcmp(action_value, "dismiss") == 0) {
-			send_data("DISMISS");
-		} else if (action_value != NULL && strcmp(action_value, "terminate") == 0) {
-			send_data("STOP");
-			service_app_exit();
-		} else {
-			dlog_print(DLOG_INFO, LOG_TAG, "Service: Unsupported action! Doing nothing...");
-			free(action_value);
-		}
+    	char *sent_at = NULL;
+    	if (app_control_get_extra_data(app_control, KEY_SENT_AT, &sent_at) == APP_CONTROL_ERROR_NONE) {
+    		ui_channel_note_latency("launch", sent_at);
+    		free(sent_at);
+    	}
+
+    	handle_ui_action(action_value);
+    	free(action_value);
 	} else {
 		dlog_print(DLOG_ERROR, LOG_TAG, "Service: Failed to get app control attribute");
 
@@ -598,10 +1567,29 @@ static void service_app_region_changed(app_event_info_h event_info, void *user_d
 
 static void service_app_low_battery(app_event_info_h event_info, void *user_data) {
 	/*APP_EVENT_LOW_BATTERY*/
+	app_event_low_battery_status_e status;
+	if (app_event_get_low_battery_status(event_info, &status) != APP_ERROR_NONE) {
+		return;
+	}
+	set_battery_tier(status == APP_EVENT_LOW_BATTERY_POWER_OFF ? BATTERY_TIER_POWER_OFF : BATTERY_TIER_LOW);
 }
 
 static void service_app_low_memory(app_event_info_h event_info, void *user_data) {
 	/*APP_EVENT_LOW_MEMORY*/
+	app_event_low_memory_status_e status;
+	if (app_event_get_low_memory_status(event_info, &status) != APP_ERROR_NONE) {
+		return;
+	}
+	switch (status) {
+		case APP_EVENT_LOW_MEMORY_HARD_WARNING:
+			set_memory_tier(MEMORY_TIER_HARD);
+			break;
+		case APP_EVENT_LOW_MEMORY_SOFT_WARNING:
+			set_memory_tier(MEMORY_TIER_SOFT);
+			break;
+		default:
+			set_memory_tier(MEMORY_TIER_NORMAL);
+	}
 }
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,82 @@
+#include "smart_alarm.h"
+
+#include "common.h"
+
+#include <dlog.h>
+
+#define MAX_SENSITIVITY 2
+// Epoch max_sum that wakes the user inside the window, per sensitivity.
+static const float movement_thresholds[MAX_SENSITIVITY + 1] = { 3.0f, 2.0f, 1.0f };
+
+static gboolean armed = FALSE;
+static gint64 window_earliest = 0;
+static gint64 window_latest = 0;
+static int window_sensitivity = 1;
+
+gboolean smart_alarm_set(gint64 earliest, gint64 latest, int sensitivity) {
+	if (latest <= 0 || earliest > latest) {
+		dlog_print(DLOG_ERROR, TAG, "Invalid smart alarm window %lld - %lld", earliest, latest);
+		armed = FALSE;
+		return FALSE;
+	}
+
+	window_earliest = earliest;
+	window_latest = latest;
+	if (sensitivity < 0) {
+		sensitivity = 0;
+	}
+	window_sensitivity = sensitivity > MAX_SENSITIVITY ? MAX_SENSITIVITY : sensitivity;
+	armed = TRUE;
+	dlog_print(DLOG_INFO, TAG, "Smart alarm window %lld - %lld, sensitivity %d", window_earliest, window_latest, window_sensitivity);
+	return TRUE;
+}
+
+void smart_alarm_clear() {
+	armed = FALSE;
+}
+
+gboolean smart_alarm_is_armed() {
+	return armed;
+}
+
+gint64 smart_alarm_latest() {
+	return window_latest;
+}
+
+smart_alarm_trigger_e smart_alarm_on_epoch(gint64 now, float max_sum, sleep_stage_e stage, gint64 stage_at) {
+	if (!armed || now < window_earliest) {
+		return SMART_ALARM_NONE;
+	}
+	if (now >= window_latest) {
+		return SMART_ALARM_DEADLINE;
+	}
+	if (stage_at < window_earliest) {
+		// Scored minutes lag the epochs, a stage from before the window says nothing about now.
+		stage = SLEEP_STAGE_UNKNOWN;
+	}
+	if (stage == SLEEP_STAGE_WAKE) {
+		return SMART_ALARM_WAKE;
+	}
+	if (stage == SLEEP_STAGE_LIGHT && window_sensitivity == MAX_SENSITIVITY) {
+		return SMART_ALARM_LIGHT;
+	}
+	if (max_sum >= movement_thresholds[window_sensitivity]) {
+		return SMART_ALARM_MOVEMENT;
+	}
+	return SMART_ALARM_NONE;
+}
+
+const char *smart_alarm_trigger_name(smart_alarm_trigger_e trigger) {
+	switch (trigger) {
+		case SMART_ALARM_WAKE:
+			return "wake";
+		case SMART_ALARM_LIGHT:
+			return "light";
+		case SMART_ALARM_MOVEMENT:
+			return "movement";
+		case SMART_ALARM_DEADLINE:
+			return "deadline";
+		default:
+			return "none";
+	}
+}
@@ -0,0 +1,172 @@
+#include "state_page.h"
+
+#include "common.h"
+#include "shared_state.h"
+
+#include <app_common.h>
+#include <dlog.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+static int fd = -1;
+static shared_state_s *page = NULL;
+
+static void begin_update() {
+	page->seq++;
+	__sync_synchronize();
+}
+
+// Writes through the mapping do not wake file monitors, so a transition rewrites seq with write()
+// to get an inotify event to the watchface. Silent updates skip that and cost the watchface nothing.
+static void end_update(gboolean notify) {
+	page->updated_at = time(NULL);
+	__sync_synchronize();
+	page->seq++;
+
+	if (notify) {
+		uint32_t seq = page->seq;
+		if (pwrite(fd, &seq, sizeof(seq), offsetof(shared_state_s, seq)) != sizeof(seq)) {
+			dlog_print(DLOG_ERROR, TAG, "Failed to notify state change");
+		}
+	}
+}
+
+static void clear_record() {
+	begin_update();
+	memset((char *)page + offsetof(shared_state_s, updated_at), 0, sizeof(shared_state_s) - offsetof(shared_state_s, updated_at));
+	page->version = SHARED_STATE_VERSION;
+	end_update(TRUE);
+}
+
+void state_page_open() {
+	char path[PATH_MAX];
+	char *data_path = app_get_data_path();
+	if (data_path == NULL) {
+		dlog_print(DLOG_ERROR, TAG, "No data path, state page disabled");
+		return;
+	}
+	snprintf(path, sizeof(path), "%s%s", data_path, SHARED_STATE_FILE);
+	free(data_path);
+
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0 || ftruncate(fd, sizeof(shared_state_s)) != 0) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to open state page %s", path);
+		state_page_close();
+		return;
+	}
+
+	page = mmap(NULL, sizeof(shared_state_s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (page == MAP_FAILED) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to map state page");
+		page = NULL;
+		state_page_close();
+		return;
+	}
+
+	// A previous instance may have died mid update, never leave seq odd or readers would keep retrying.
+	if (page->seq & 1) {
+		page->seq++;
+	}
+	// A fresh service knows nothing yet, start from a clean record.
+	clear_record();
+}
+
+void state_page_close() {
+	if (page) {
+		// Nothing is tracked once the service is gone, do not leave the watchface with a stale record.
+		clear_record();
+		munmap(page, sizeof(shared_state_s));
+		page = NULL;
+	}
+	if (fd >= 0) {
+		close(fd);
+		fd = -1;
+	}
+}
+
+void state_page_set_tracking(gboolean tracking) {
+	if (!page) {
+		return;
+	}
+	begin_update();
+	page->tracking = tracking;
+	if (tracking) {
+		page->epoch_count = 0;
+		page->last_epoch_at = 0;
+		page->hr_count = 0;
+	} else {
+		page->paused_till = 0;
+	}
+	end_update(TRUE);
+}
+
+void state_page_answer_start(gboolean started) {
+	if (!page) {
+		return;
+	}
+	begin_update();
+	page->start_result = started ? SHARED_START_TRACKING : SHARED_START_REJECTED;
+	page->start_answers++;
+	end_update(TRUE);
+}
+
+void state_page_set_paused_till(gint64 paused_till) {
+	if (!page) {
+		return;
+	}
+	begin_update();
+	page->paused_till = paused_till;
+	end_update(TRUE);
+}
+
+void state_page_set_alarm_active(gboolean active) {
+	if (!page) {
+		return;
+	}
+	begin_update();
+	page->alarm_active = active;
+	end_update(TRUE);
+}
+
+void state_page_set_link(gboolean connected) {
+	if (!page || page->link_connected == connected) {
+		return;
+	}
+	begin_update();
+	page->link_connected = connected;
+	end_update(TRUE);
+}
+
+void state_page_set_last_epoch(float max_sum, float avg_sum) {
+	if (!page) {
+		return;
+	}
+	begin_update();
+	page->last_epoch_at = time(NULL);
+	page->last_epoch_max_sum = max_sum;
+	page->last_epoch_avg_sum = avg_sum;
+	page->ring[page->epoch_count % SHARED_STATE_RING].max_sum = max_sum;
+	page->ring[page->epoch_count % SHARED_STATE_RING].avg_sum = avg_sum;
+	page->epoch_count++;
+	end_update(FALSE);
+}
+
+void state_page_add_hr(gint64 at, float bpm, float confidence) {
+	if (!page) {
+		return;
+	}
+	begin_update();
+	shared_hr_s *hr = &page->hr_ring[page->hr_count % SHARED_STATE_HR_RING];
+	hr->at = at;
+	hr->bpm = bpm;
+	hr->confidence = confidence;
+	page->hr_count++;
+	end_update(FALSE);
+}
@@ -0,0 +1,144 @@
+#include "ui_channel.h"
+
+#include "common.h"
+
+#include <bundle.h>
+#include <dlog.h>
+#include <Ecore.h>
+#include <message_port.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int local_port_id = -1;
+static ui_action_cb action_callback;
+
+// Last state delivered over the port, per message type. Empty when the watchface has to be told again.
+static char last_state[UI_MESSAGE_TYPE_COUNT][64];
+
+// Command latency per delivery path, so the port can be compared with launch requests.
+static struct latency_stats {
+	long count;
+	double total_ms;
+	double max_ms;
+} port_latency, launch_latency;
+
+static void fill_sent_at(char *buf, size_t len) {
+	snprintf(buf, len, "%.0f", ecore_time_unix_get() * 1000.0);
+}
+
+void ui_channel_note_latency(const char *via, const char *sent_at) {
+	if (sent_at == NULL) {
+		return;
+	}
+
+	struct latency_stats *stats = strcmp(via, "port") == 0 ? &port_latency : &launch_latency;
+	const double ms = ecore_time_unix_get() * 1000.0 - atof(sent_at);
+	stats->count++;
+	stats->total_ms += ms;
+	if (ms > stats->max_ms) {
+		stats->max_ms = ms;
+	}
+	dlog_print(DLOG_INFO, TAG, "Service: Command via %s took %.0f ms (avg %.1f ms, max %.0f ms, %ld commands)",
+			via, ms, stats->total_ms / stats->count, stats->max_ms, stats->count);
+}
+
+static void on_port_message(int local_port_id, const char *remote_app_id, const char *remote_port,
+		bool trusted_remote_port, bundle *message, void *user_data) {
+	char *action = NULL;
+	char *sent_at = NULL;
+
+	if (bundle_get_str(message, KEY_ACTION, &action) != 0 || action == NULL) {
+		dlog_print(DLOG_ERROR, TAG, "Service: Port message without action from %s", remote_app_id);
+		return;
+	}
+	if (bundle_get_str(message, KEY_SENT_AT, &sent_at) == 0) {
+		ui_channel_note_latency("port", sent_at);
+	}
+	// Strings returned by bundle_get_str belong to the bundle.
+	action_callback(action);
+}
+
+void ui_channel_init(ui_action_cb action_received) {
+	action_callback = action_received;
+	memset(last_state, 0, sizeof(last_state));
+
+	local_port_id = message_port_register_local_port(SERVICE_PORT, on_port_message, NULL);
+	if (local_port_id < 0) {
+		dlog_print(DLOG_ERROR, TAG, "Service: Failed to register port (%d), using launch requests only", local_port_id);
+	}
+}
+
+void ui_channel_shutdown() {
+	if (local_port_id >= 0) {
+		message_port_unregister_local_port(local_port_id);
+		local_port_id = -1;
+	}
+}
+
+static bool send_port_message(ui_message_type_e type, const char *command) {
+	bool exists = false;
+	if (message_port_check_remote_port(WATCHFACE_APP_ID, WATCHFACE_PORT, &exists) != MESSAGE_PORT_ERROR_NONE || !exists) {
+		return false;
+	}
+
+	char type_str[8];
+	char sent_at[32];
+	snprintf(type_str, sizeof(type_str), "%d", type);
+	fill_sent_at(sent_at, sizeof(sent_at));
+
+	bundle *message = bundle_create();
+	bundle_add_str(message, KEY_ACTION, command);
+	bundle_add_str(message, KEY_TYPE, type_str);
+	bundle_add_str(message, KEY_SENT_AT, sent_at);
+	int ret = message_port_send_message(WATCHFACE_APP_ID, WATCHFACE_PORT, message);
+	bundle_free(message);
+
+	if (ret != MESSAGE_PORT_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Service: Port message failed (%d): %s", ret, command);
+		return false;
+	}
+	dlog_print(DLOG_INFO, TAG, "Service: Port message sent: %s", command);
+	return true;
+}
+
+static void send_launch_request(const char *command) {
+    app_control_h app_control;
+	if (app_control_create(&app_control) == APP_CONTROL_ERROR_NONE) {
+		char sent_at[32];
+		fill_sent_at(sent_at, sizeof(sent_at));
+
+		int res1 = 0, res2 = 0, res3 = 0;
+		if (((res1 = app_control_set_app_id(app_control, WATCHFACE_APP_ID)) == APP_CONTROL_ERROR_NONE)
+			&& ((res2 = app_control_add_extra_data(app_control, KEY_ACTION, command)) == APP_CONTROL_ERROR_NONE)
+			&& (app_control_add_extra_data(app_control, KEY_SENT_AT, sent_at) == APP_CONTROL_ERROR_NONE)
+			&& ((res3 = app_control_send_launch_request(app_control, NULL, NULL)) == APP_CONTROL_ERROR_NONE)) {
+			dlog_print(DLOG_INFO, TAG, "Service: App command request sent: %s", command);
+		} else {
+			dlog_print(DLOG_ERROR, TAG, "Service: App command request sending failed! Err: %d %d %d", res1, res2, res3);
+		}
+		if (app_control_destroy(app_control) == APP_CONTROL_ERROR_NONE) {
+			dlog_print(DLOG_INFO, TAG, "Service: App control destroyed.");
+		}
+	} else {
+		dlog_print(DLOG_ERROR, TAG, "Service: App control creation failed!");
+	}
+}
+
+void ui_channel_send(ui_message_type_e type, const char *command) {
+	if (type != UI_MESSAGE_EVENT && strcmp(last_state[type], command) == 0) {
+		dlog_print(DLOG_DEBUG, TAG, "Service: Coalesced repeated state: %s", command);
+		return;
+	}
+
+	if (send_port_message(type, command)) {
+		if (type != UI_MESSAGE_EVENT) {
+			snprintf(last_state[type], sizeof(last_state[type]), "%s", command);
+		}
+		return;
+	}
+
+	// The watchface is not running (or has no port yet), launch it. It starts from scratch, so forget what it knew.
+	memset(last_state, 0, sizeof(last_state));
+	send_launch_request(command);
+}
@@ -0,0 +1,84 @@
+#include "wake_alarm.h"
+
+#include "common.h"
+
+#include <app_alarm.h>
+#include <dlog.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Extra of the app control the alarm service launches us with, the value is the wake_alarm_e.
+#define KEY_WAKE_ALARM "wake_alarm"
+
+static int alarm_ids[WAKE_ALARM_COUNT];
+static gboolean armed[WAKE_ALARM_COUNT];
+
+gboolean wake_alarm_set(wake_alarm_e alarm, gint64 at) {
+	wake_alarm_cancel(alarm);
+
+	app_control_h app_control;
+	if (app_control_create(&app_control) != APP_CONTROL_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to create wake alarm app control");
+		return FALSE;
+	}
+
+	char *app_id = NULL;
+	char value[4];
+	snprintf(value, sizeof(value), "%d", alarm);
+	// Rounded up, the alarm must not go off before the deadline it stands for.
+	time_t when = (time_t)((at + 999) / 1000);
+	const time_t now = time(NULL);
+	if (when <= now) {
+		when = now + 1;
+	}
+	struct tm date;
+	localtime_r(&when, &date);
+
+	int err = -1;
+	if (app_get_id(&app_id) == APP_ERROR_NONE
+		&& app_control_set_app_id(app_control, app_id) == APP_CONTROL_ERROR_NONE
+		&& app_control_add_extra_data(app_control, KEY_WAKE_ALARM, value) == APP_CONTROL_ERROR_NONE)
+	{
+		err = alarm_schedule_at_date(app_control, &date, 0, &alarm_ids[alarm]);
+	}
+	free(app_id);
+	app_control_destroy(app_control);
+
+	if (err != ALARM_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to set wake alarm %d (%d)", alarm, err);
+		return FALSE;
+	}
+	armed[alarm] = TRUE;
+	dlog_print(DLOG_INFO, TAG, "Wake alarm %d set for %lld", alarm, (long long)when * 1000);
+	return TRUE;
+}
+
+void wake_alarm_cancel(wake_alarm_e alarm) {
+	if (!armed[alarm]) {
+		return;
+	}
+	armed[alarm] = FALSE;
+
+	const int err = alarm_cancel(alarm_ids[alarm]);
+	if (err != ALARM_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, TAG, "Failed to cancel wake alarm %d (%d)", alarm, err);
+	}
+}
+
+gboolean wake_alarm_from_app_control(app_control_h app_control, wake_alarm_e *alarm) {
+	char *value = NULL;
+	if (app_control_get_extra_data(app_control, KEY_WAKE_ALARM, &value) != APP_CONTROL_ERROR_NONE || !value) {
+		return FALSE;
+	}
+
+	const int index = atoi(value);
+	free(value);
+	if (index < 0 || index >= WAKE_ALARM_COUNT) {
+		dlog_print(DLOG_ERROR, TAG, "Unknown wake alarm %d", index);
+		return FALSE;
+	}
+	armed[index] = FALSE;
+	*alarm = index;
+	return TRUE;
+}
@@ -0,0 +1,51 @@
+// Cost of the PPG kernels: per sample filter and peak detection, and the summary at the end of a window.
+#include "ppg_hrv.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#define RATE_HZ 100.0
+#define WINDOW_SEC 60
+#define WINDOWS 2000
+
+static double now_sec() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+	const long window_samples = (long)(WINDOW_SEC * RATE_HZ);
+	static float signal[WINDOW_SEC * 100];
+	ppg_hrv_summary_s summary;
+	int summaries = 0;
+
+	// One minute of a 65 bpm pulse with breathing drift, generated once so only the kernels are timed.
+	for (long i = 0; i < window_samples; i++) {
+		const double t = i / RATE_HZ;
+		const double phase = fmod(t, 60.0 / 65.0) - 0.2;
+		signal[i] = (float)(10000.0 - 300.0 * exp(-phase * phase / 0.0098) + 60.0 * sin(2 * M_PI * 0.25 * t));
+	}
+
+	double add_sec = 0, summary_sec = 0;
+	for (int w = 0; w < WINDOWS; w++) {
+		double start = now_sec();
+		ppg_hrv_reset(RATE_HZ);
+		for (long i = 0; i < window_samples; i++) {
+			ppg_hrv_add((unsigned long long)(i * 1e6 / RATE_HZ), signal[i]);
+		}
+		add_sec += now_sec() - start;
+
+		start = now_sec();
+		summaries += ppg_hrv_summary(&summary);
+		summary_sec += now_sec() - start;
+	}
+
+	const double ns_per_sample = add_sec * 1e9 / ((double)WINDOWS * window_samples);
+	printf("ppg_hrv_add: %.1f ns per sample, %.4f%% of one core at %.0f Hz\n",
+			ns_per_sample, ns_per_sample * RATE_HZ / 1e7, RATE_HZ);
+	printf("ppg_hrv_summary: %.0f ns per window (%d of %d windows summarized)\n",
+			summary_sec * 1e9 / WINDOWS, summaries, WINDOWS);
+	return summaries == WINDOWS ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+#ifndef __TEST_STUB_ECORE_H__
+#define __TEST_STUB_ECORE_H__
+
+// Ecore timers on a fake clock: nothing runs by itself, the test moves the clock and fires what is due.
+#include <Eina.h>
+
+#define ECORE_CALLBACK_CANCEL EINA_FALSE
+#define ECORE_CALLBACK_RENEW EINA_TRUE
+
+typedef Eina_Bool (*Ecore_Task_Cb)(void *data);
+typedef struct _Ecore_Timer Ecore_Timer;
+
+Ecore_Timer *ecore_timer_add(double in, Ecore_Task_Cb func, const void *data);
+void *ecore_timer_del(Ecore_Timer *timer);
+double ecore_time_get(void);
+double ecore_time_unix_get(void);
+
+// Test side of the fake clock.
+void fake_clock_set(double now);
+// Fires Ecore timers in deadline order until the clock reaches `until`, returns how many fired.
+int fake_clock_run_until(double until);
+// Deadline of the earliest pending Ecore timer, negative when none is pending.
+double fake_clock_next_timer(void);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef __TEST_STUB_EINA_H__
+#define __TEST_STUB_EINA_H__
+
+// Minimal doubly linked Eina_List with the calls and macros the service uses.
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned char Eina_Bool;
+#define EINA_TRUE ((Eina_Bool)1)
+#define EINA_FALSE ((Eina_Bool)0)
+#define EINA_UNUSED __attribute__((unused))
+
+typedef struct _Eina_List Eina_List;
+struct _Eina_List {
+	void *data;
+	Eina_List *next;
+	Eina_List *prev;
+};
+
+Eina_List *eina_list_append(Eina_List *list, const void *data);
+Eina_List *eina_list_remove(Eina_List *list, const void *data);
+Eina_List *eina_list_remove_list(Eina_List *list, Eina_List *remove_list);
+unsigned int eina_list_count(const Eina_List *list);
+
+static inline void *eina_list_data_get(const Eina_List *list) {
+	return list ? list->data : NULL;
+}
+
+static inline Eina_List *eina_list_next(const Eina_List *list) {
+	return list ? list->next : NULL;
+}
+
+#define EINA_LIST_FOREACH(list, l, _data) \
+	for (l = list, _data = eina_list_data_get(l); l; l = eina_list_next(l), _data = eina_list_data_get(l))
+
+#define EINA_LIST_FREE(list, _data) \
+	for (_data = eina_list_data_get(list); list; \
+			list = eina_list_remove_list(list, list), _data = eina_list_data_get(list))
+
+#endif
@@ -0,0 +1,129 @@
+#include <Ecore.h>
+
+#include <stdlib.h>
+
+struct _Ecore_Timer {
+	double at;
+	double in;
+	Ecore_Task_Cb func;
+	const void *data;
+};
+
+#define FAKE_CLOCK_MAX_CALLBACKS 100000
+
+static double fake_now = 0;
+static Eina_List *timers = NULL;
+
+Eina_List *eina_list_append(Eina_List *list, const void *data) {
+	Eina_List *node = calloc(1, sizeof(Eina_List));
+	node->data = (void *)data;
+	if (!list) {
+		return node;
+	}
+	Eina_List *last = list;
+	while (last->next) {
+		last = last->next;
+	}
+	last->next = node;
+	node->prev = last;
+	return list;
+}
+
+Eina_List *eina_list_remove_list(Eina_List *list, Eina_List *remove_list) {
+	if (!remove_list) {
+		return list;
+	}
+	if (remove_list->prev) {
+		remove_list->prev->next = remove_list->next;
+	} else {
+		list = remove_list->next;
+	}
+	if (remove_list->next) {
+		remove_list->next->prev = remove_list->prev;
+	}
+	free(remove_list);
+	return list;
+}
+
+Eina_List *eina_list_remove(Eina_List *list, const void *data) {
+	for (Eina_List *l = list; l; l = l->next) {
+		if (l->data == data) {
+			return eina_list_remove_list(list, l);
+		}
+	}
+	return list;
+}
+
+unsigned int eina_list_count(const Eina_List *list) {
+	unsigned int count = 0;
+	for (; list; list = list->next) {
+		count++;
+	}
+	return count;
+}
+
+Ecore_Timer *ecore_timer_add(double in, Ecore_Task_Cb func, const void *data) {
+	Ecore_Timer *timer = calloc(1, sizeof(Ecore_Timer));
+	timer->in = in;
+	timer->at = fake_now + in;
+	timer->func = func;
+	timer->data = data;
+	timers = eina_list_append(timers, timer);
+	return timer;
+}
+
+void *ecore_timer_del(Ecore_Timer *timer) {
+	if (timer) {
+		timers = eina_list_remove(timers, timer);
+		free(timer);
+	}
+	return NULL;
+}
+
+double ecore_time_get(void) {
+	return fake_now;
+}
+
+double ecore_time_unix_get(void) {
+	return 1500000000.0 + fake_now;
+}
+
+void fake_clock_set(double now) {
+	fake_now = now;
+}
+
+static Ecore_Timer *earliest() {
+	Ecore_Timer *best = NULL;
+	for (Eina_List *l = timers; l; l = l->next) {
+		Ecore_Timer *timer = l->data;
+		if (!best || timer->at < best->at) {
+			best = timer;
+		}
+	}
+	return best;
+}
+
+double fake_clock_next_timer(void) {
+	Ecore_Timer *timer = earliest();
+	return timer ? timer->at : -1;
+}
+
+int fake_clock_run_until(double until) {
+	int count = 0;
+	Ecore_Timer *timer;
+
+	// The cap turns a timer re-armed for the same instant over and over into a failure instead of a hang.
+	while ((timer = earliest()) && timer->at <= until && count < FAKE_CLOCK_MAX_CALLBACKS) {
+		fake_now = timer->at;
+		timers = eina_list_remove(timers, timer);
+		if (timer->func((void *)timer->data)) {
+			timer->at = fake_now + timer->in;
+			timers = eina_list_append(timers, timer);
+		} else {
+			free(timer);
+		}
+		count++;
+	}
+	fake_now = until;
+	return count;
+}
@@ -0,0 +1,14 @@
+#ifndef __TEST_STUB_GLIB_H__
+#define __TEST_STUB_GLIB_H__
+
+// Only the glib types the service modules use, so host tests need no glib headers.
+typedef int gboolean;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#endif
@@ -0,0 +1,186 @@
+// RR extraction from a synthetic green LED PPG with a known beat pattern.
+#include "ppg_hrv.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define RATE_HZ 100.0
+// Width of one pulse dip, about the systolic upstroke of a resting wrist PPG.
+#define PULSE_SIGMA_SEC 0.07
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+	if (!(cond)) { \
+		failures++; \
+		fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+		fprintf(stderr, __VA_ARGS__); \
+		fprintf(stderr, "\n"); \
+	} \
+} while (0)
+
+typedef struct expected {
+	double mean;
+	double sdnn;
+	double rmssd;
+} expected_s;
+
+#define MAX_BEATS 1024
+// Filters of the extractor settle within this, earlier beats are not expected to be counted.
+#define SETTLED_SEC 1.5
+
+// Beats of the last fed signal, a missed beat has no pulse.
+static double beat_times[MAX_BEATS];
+static int beat_missed[MAX_BEATS];
+static int beat_count = 0;
+
+static unsigned int noise_state = 1;
+
+// Deterministic noise in [-1, 1].
+static double noise() {
+	noise_state = noise_state * 1103515245u + 12345u;
+	return ((noise_state >> 16) & 0x7fff) / 16383.5 - 1.0;
+}
+
+// Statistics of the RR intervals actually fed: only between two present beats, successive differences only between
+// two such intervals in a row.
+static expected_s fed_stats(double seconds) {
+	expected_s e = { 0 };
+	double sq_sum = 0, diff_sq_sum = 0, last_rr = 0;
+	int count = 0, diff_count = 0;
+
+	for (int i = 1; i < beat_count; i++) {
+		const double rr = (beat_times[i] - beat_times[i - 1]) * 1000.0;
+		const int valid = !beat_missed[i] && !beat_missed[i - 1] && beat_times[i - 1] >= SETTLED_SEC
+				&& beat_times[i] < seconds - 0.2;
+		if (!valid) {
+			last_rr = 0;
+			continue;
+		}
+		if (last_rr > 0) {
+			diff_sq_sum += (rr - last_rr) * (rr - last_rr);
+			diff_count++;
+		}
+		e.mean += rr;
+		sq_sum += rr * rr;
+		count++;
+		last_rr = rr;
+	}
+	e.mean /= count;
+	e.sdnn = sqrt((sq_sum - count * e.mean * e.mean) / (count - 1));
+	e.rmssd = sqrt(diff_sq_sum / diff_count);
+	return e;
+}
+
+// Feeds `seconds` of raw PPG with the RR pattern repeated. The beat with index `skip` produces no pulse (a missed beat
+// as seen with poor skin contact).
+static void feed(const double *rr_ms, int count, double seconds, double noise_amplitude, int skip) {
+	double beat_at = 0.5;
+	int beat = 0;
+
+	beat_count = 0;
+	ppg_hrv_reset(RATE_HZ);
+	for (long i = 0; i < (long)(seconds * RATE_HZ); i++) {
+		const double t = i / RATE_HZ;
+		while (t > beat_at + 4 * PULSE_SIGMA_SEC || beat_count == 0) {
+			if (beat_count > 0) {
+				beat_at += rr_ms[beat++ % count] / 1000.0;
+			}
+			beat_times[beat_count] = beat_at;
+			beat_missed[beat_count] = beat == skip;
+			beat_count++;
+		}
+
+		double pulse = 0;
+		if (beat != skip) {
+			// Breathing modulates the pulse amplitude by about a quarter.
+			pulse = (1.0 + 0.25 * sin(2 * M_PI * 0.2 * t))
+					* exp(-(t - beat_at) * (t - beat_at) / (2 * PULSE_SIGMA_SEC * PULSE_SIGMA_SEC));
+		}
+		// Reflected light: dips with every pulse, on top of a slow drift from breathing and contact pressure.
+		const double raw = 10000.0 - 300.0 * pulse + 60.0 * sin(2 * M_PI * 0.25 * t) + noise_amplitude * noise();
+		ppg_hrv_add((unsigned long long)(t * 1e6), (float)raw);
+	}
+}
+
+static void check_summary(const char *name, const double *rr_ms, int count, double seconds, double noise_amplitude,
+		int skip, double tolerance_ms) {
+	ppg_hrv_summary_s s = { 0 };
+
+	feed(rr_ms, count, seconds, noise_amplitude, skip);
+	const expected_s e = fed_stats(seconds);
+	const gboolean ok = ppg_hrv_summary(&s);
+
+	CHECK(ok, "%s: no summary", name);
+	CHECK(fabs(s.mean_rr_ms - e.mean) < 2.0, "%s: mean RR %.1f, expected %.1f", name, s.mean_rr_ms, e.mean);
+	CHECK(fabs(s.sdnn_ms - e.sdnn) < tolerance_ms, "%s: SDNN %.1f, expected %.1f", name, s.sdnn_ms, e.sdnn);
+	CHECK(fabs(s.rmssd_ms - e.rmssd) < tolerance_ms, "%s: RMSSD %.1f, expected %.1f", name, s.rmssd_ms, e.rmssd);
+	printf("%s: mean RR %.1f/%.1f, SDNN %.1f/%.1f, RMSSD %.1f/%.1f ms (measured/expected), %d RR\n",
+			name, s.mean_rr_ms, e.mean, s.sdnn_ms, e.sdnn, s.rmssd_ms, e.rmssd, s.rr_count);
+}
+
+static void test_steady() {
+	const double rr[] = { 1000 };
+	ppg_hrv_summary_s s = { 0 };
+
+	feed(rr, 1, 60, 2.0, -1);
+	CHECK(ppg_hrv_summary(&s), "steady: no summary");
+	CHECK(fabs(s.mean_rr_ms - 1000) < 1.0, "steady: mean RR %.1f", s.mean_rr_ms);
+	CHECK(s.sdnn_ms < 8.0 && s.rmssd_ms < 8.0, "steady: SDNN %.1f, RMSSD %.1f", s.sdnn_ms, s.rmssd_ms);
+	CHECK(s.rr_count >= 55, "steady: %d RR in 60 s", s.rr_count);
+}
+
+static void test_patterns() {
+	const double alternating[] = { 800, 850 };
+	const double sinus_arrhythmia[] = { 900, 940, 980, 1000, 980, 940, 900, 870, 850, 870 };
+
+	check_summary("alternating", alternating, 2, 60, 2.0, -1, 5.0);
+	check_summary("sinus arrhythmia", sinus_arrhythmia, 10, 60, 2.0, -1, 5.0);
+	check_summary("noisy", sinus_arrhythmia, 10, 60, 15.0, -1, 8.0);
+	// Beats between samples, the peak times are quantized to the 10 ms sample period.
+	const double off_grid[] = { 912, 947, 983, 1004, 978, 936, 903, 874, 851, 866 };
+	check_summary("off grid", off_grid, 10, 60, 2.0, -1, 5.0);
+}
+
+// A missed pulse gives one double length RR which has to be rejected, not averaged in.
+static void test_missed_beat() {
+	const double rr[] = { 900, 940, 980, 1000, 980, 940, 900, 870, 850, 870 };
+	check_summary("missed beat", rr, 10, 60, 2.0, 30, 5.0);
+}
+
+// A few beats are not enough for SDNN and RMSSD, about 30 beats (the window the service keeps the LED on for) are.
+static void test_window_length() {
+	const double rr[] = { 900, 940, 980, 1000, 980, 940, 900, 870, 850, 870 };
+	ppg_hrv_summary_s s = { 0 };
+
+	feed(rr, 10, 8, 2.0, -1);
+	CHECK(!ppg_hrv_summary(&s), "summary from %d RR", s.rr_count);
+
+	check_summary("30 beats", rr, 10, 31, 2.0, -1, 5.0);
+	CHECK(ppg_hrv_rr_count() >= 28, "%d RR in 31 s", ppg_hrv_rr_count());
+}
+
+static void test_no_pulse() {
+	ppg_hrv_summary_s s = { 0 };
+
+	ppg_hrv_reset(RATE_HZ);
+	for (long i = 0; i < 30 * (long)RATE_HZ; i++) {
+		ppg_hrv_add((unsigned long long)(i * 1e6 / RATE_HZ), (float)(10000.0 + 2.0 * noise()));
+	}
+	CHECK(!ppg_hrv_summary(&s), "noise only gave a summary with %d RR", s.rr_count);
+}
+
+int main() {
+	test_steady();
+	test_patterns();
+	test_missed_beat();
+	test_window_length();
+	test_no_pulse();
+
+	if (failures) {
+		fprintf(stderr, "test_ppg_hrv: %d failures\n", failures);
+		return 1;
+	}
+	printf("test_ppg_hrv: ok\n");
+	return 0;
+}
@@ -0,0 +1,111 @@
+// Timer wheel on a fake clock: every timer has to fire on the tick it is due, including the ticks where it cascades
+// down from a higher level.
+#include "scheduler.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define TICK_SEC 0.25
+#define LEVEL1_SEC (64 * TICK_SEC)
+#define LEVEL2_SEC (64 * 64 * TICK_SEC)
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+	if (!(cond)) { \
+		failures++; \
+		fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+		fprintf(stderr, __VA_ARGS__); \
+		fprintf(stderr, "\n"); \
+	} \
+} while (0)
+
+typedef struct probe {
+	int count;
+	double first_at;
+	double last_at;
+	int renew_times;
+} probe_s;
+
+static Eina_Bool probe_cb(void *data) {
+	probe_s *probe = data;
+	if (probe->count == 0) {
+		probe->first_at = ecore_time_get();
+	}
+	probe->last_at = ecore_time_get();
+	probe->count++;
+	return probe->count < probe->renew_times ? ECORE_CALLBACK_RENEW : ECORE_CALLBACK_CANCEL;
+}
+
+static void test_fires_on_time() {
+	probe_s probe = { .renew_times = 1 };
+
+	fake_clock_set(0);
+	scheduler_timer_add(2.0, 0, probe_cb, &probe);
+	fake_clock_run_until(10.0);
+
+	CHECK(probe.count == 1, "fired %d times", probe.count);
+	CHECK(fabs(probe.first_at - 2.0) < 1e-9, "fired at %.2f instead of 2.00", probe.first_at);
+}
+
+// Timers expiring exactly on a level boundary sit in the higher level until the tick they are due on.
+// Start times are multiples of the level span so the expiry lands on the cascade tick.
+static void check_boundary(double start, double interval) {
+	probe_s probe = { .renew_times = 1 };
+
+	fake_clock_set(start);
+	scheduler_timer_add(interval, 0, probe_cb, &probe);
+	const int wakeups = fake_clock_run_until(start + interval + 2.0);
+
+	CHECK(probe.count == 1, "%.0f s timer fired %d times", interval, probe.count);
+	CHECK(fabs(probe.first_at - (start + interval)) < 1e-9, "%.0f s timer fired at %.2f instead of %.2f",
+			interval, probe.first_at, start + interval);
+	CHECK(wakeups <= 2, "%.0f s timer took %d wakeups", interval, wakeups);
+}
+
+static void test_cascade_boundary() {
+	check_boundary(6 * LEVEL1_SEC, LEVEL1_SEC);
+	check_boundary(12 * LEVEL1_SEC, 2 * LEVEL1_SEC);
+	check_boundary(LEVEL2_SEC, LEVEL2_SEC);
+}
+
+// A periodic timer crossing many level boundaries keeps its phase.
+static void test_periodic_phase() {
+	probe_s probe = { .renew_times = 100 };
+
+	fake_clock_set(10000.0);
+	scheduler_timer_add(LEVEL1_SEC, 0, probe_cb, &probe);
+	fake_clock_run_until(10000.0 + 100 * LEVEL1_SEC + 1.0);
+
+	CHECK(probe.count == 100, "periodic timer fired %d times", probe.count);
+	CHECK(fabs(probe.last_at - (10000.0 + 100 * LEVEL1_SEC)) < 1e-9, "last periodic run at %.2f", probe.last_at);
+}
+
+// A deferrable timer joins the wakeup of a stricter one inside its slack instead of waking on its own.
+static void test_slack_shares_wakeup() {
+	probe_s strict = { .renew_times = 1 };
+	probe_s lazy = { .renew_times = 1 };
+
+	fake_clock_set(20000.0);
+	scheduler_timer_add(5.0, 0, probe_cb, &strict);
+	scheduler_timer_add(4.0, 2.0, probe_cb, &lazy);
+	const int wakeups = fake_clock_run_until(20010.0);
+
+	CHECK(strict.count == 1 && lazy.count == 1, "fired %d and %d times", strict.count, lazy.count);
+	CHECK(fabs(lazy.first_at - 20005.0) < 1e-9, "deferrable timer fired at %.2f", lazy.first_at);
+	CHECK(wakeups == 1, "%d wakeups for two timers", wakeups);
+}
+
+int main() {
+	test_fires_on_time();
+	test_cascade_boundary();
+	test_periodic_phase();
+	test_slack_shares_wakeup();
+
+	if (failures) {
+		fprintf(stderr, "test_scheduler: %d failures\n", failures);
+		return 1;
+	}
+	printf("test_scheduler: ok\n");
+	return 0;
+}
@@ -0,0 +1,380 @@
+/*
+ * Host benchmark of the watch face on the Ecore_Evas buffer engine at the Gear Fit2 resolution.
+ * The watch face is built from its own sources, only the framework (stubs/) and the service
+ * (standin_service.c on top of the service's state_page.c) are replaced.
+ *
+ * Usage: bench_watchface [all|ticks|transitions|sparkline|tap]
+ *   ticks        Cost of an ambient tick and of the frame it causes, in each UI state
+ *   transitions  Watch to alarm screen and back, snoozing, and the RSS and Evas objects over the cycles
+ *   sparkline    Cost of sparkline_update() for one new epoch, early and late in a session, and for a full ring
+ *   tap          Double tap on the watch screen to the first frame showing it, to the service's confirmation,
+ *                and to the revert when the service rejects the start or never answers
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "fake_watch_app.h"
+#include "standin_service.h"
+#include "state_page.h"
+
+/* The watch face, with its main() out of the way */
+#define main watchface_main
+#include "../src/main.c"
+#undef main
+
+#define TICKS_PER_STATE 600
+#define SNOOZE_CYCLES 100
+#define SPARKLINE_UPDATES 10000
+#define TAPS 50
+
+static struct bench_info {
+	Ecore_Evas *ee;
+	long pixels;
+} s_bench = {
+	.ee = NULL,
+	.pixels = 0,
+};
+
+static double _now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long _rss_kb(void)
+{
+	char line[128];
+	long kb = -1;
+	FILE *f = fopen("/proc/self/status", "r");
+
+	if (f == NULL)
+		return -1;
+	while (fgets(line, sizeof(line), f))
+		if (sscanf(line, "VmRSS: %ld kB", &kb) == 1)
+			break;
+	fclose(f);
+	return kb;
+}
+
+static int _objects_count(const Evas_Object *obj)
+{
+	Eina_List *members = evas_object_smart_members_get(obj);
+	Evas_Object *member;
+	int count = 1;
+
+	EINA_LIST_FREE(members, member)
+		count += _objects_count(member);
+
+	return count;
+}
+
+static void _render_post_cb(void *data, Evas *e, void *event_info)
+{
+	Evas_Event_Render_Post *post = event_info;
+	Eina_Rectangle *rect;
+	Eina_List *l;
+
+	if (post == NULL)
+		return;
+	EINA_LIST_FOREACH(post->updated_area, l, rect)
+		s_bench.pixels += (long)rect->w * rect->h;
+}
+
+/* Delivers queued Edje signals and messages, then renders one frame, like one pass of the main loop */
+static double _frame(void)
+{
+	double start = _now();
+
+	edje_message_signal_process();
+	ecore_evas_manual_render(s_bench.ee);
+	return (_now() - start) * 1000.0;
+}
+
+struct loop_wait {
+	const bool *value;
+	bool expected;
+	Ecore_Timer *timeout;
+};
+
+static Eina_Bool _loop_check_cb(void *data)
+{
+	struct loop_wait *wait = data;
+
+	if (*wait->value == wait->expected)
+		ecore_main_loop_quit();
+	return ECORE_CALLBACK_RENEW;
+}
+
+static Eina_Bool _loop_timeout_cb(void *data)
+{
+	struct loop_wait *wait = data;
+
+	wait->timeout = NULL;
+	ecore_main_loop_quit();
+	return ECORE_CALLBACK_CANCEL;
+}
+
+/* Runs the main loop until *value equals expected, so file monitor events and timers get dispatched */
+static bool _loop_until(const bool *value, bool expected, double timeout)
+{
+	struct loop_wait wait = { value, expected, NULL };
+	Ecore_Idle_Enterer *check;
+
+	if (*value == expected)
+		return true;
+
+	/* The idle enterer runs after every batch of events, before the loop goes to sleep */
+	check = ecore_idle_enterer_add(_loop_check_cb, &wait);
+	wait.timeout = ecore_timer_add(timeout, _loop_timeout_cb, &wait);
+	ecore_main_loop_begin();
+	ecore_idle_enterer_del(check);
+	if (wait.timeout)
+		ecore_timer_del(wait.timeout);
+	return *value == expected;
+}
+
+static bool _tracking_set(bool tracking)
+{
+	state_page_set_tracking(tracking);
+	return _loop_until(&is_tracking, tracking, 1.0);
+}
+
+static void _bench_ticks(appdata_s *ad)
+{
+	static const char *states[] = { "ambient", "tracking", "alarm" };
+	int s, i;
+
+	app_ambient_changed(true, ad);
+	for (s = 0; s < 3; s++) {
+		double update_ms = 0, render_ms = 0;
+		long pixels = 0;
+
+		_tracking_set(s > 0);
+		if (s == 2)
+			show_alarm_screen(ad);
+		_frame();
+
+		for (i = 0; i < TICKS_PER_STATE; i++) {
+			watch_time_h watch_time = fake_watch_time_new(i / 60 % 24, i % 60, 0);
+			double start;
+
+			if (s == 1)
+				state_page_set_last_epoch(i % 10, i % 10 / 2.0f);
+
+			start = _now();
+			app_ambient_tick(watch_time, ad);
+			update_ms += (_now() - start) * 1000.0;
+			watch_time_delete(watch_time);
+
+			s_bench.pixels = 0;
+			render_ms += _frame();
+			pixels += s_bench.pixels;
+		}
+		printf("tick %-8s: update %.3f ms, render %.3f ms, %ld px redrawn (avg over %d ticks)\n",
+				states[s], update_ms / TICKS_PER_STATE, render_ms / TICKS_PER_STATE, pixels / TICKS_PER_STATE, TICKS_PER_STATE);
+	}
+
+	show_watch_screen(ad);
+	app_ambient_changed(false, ad);
+	_tracking_set(false);
+	_frame();
+}
+
+/* Both screens are retained, so cycling through them must not leave objects or memory behind */
+static bool _bench_transitions(appdata_s *ad)
+{
+	double to_alarm = 0, to_alarm_max = 0, to_watch = 0, to_watch_max = 0;
+	long rss_start, rss_first = 0, rss_end;
+	int objects_start, objects_end;
+	int i;
+
+	rss_start = _rss_kb();
+	objects_start = _objects_count(ad->win);
+	for (i = 0; i < SNOOZE_CYCLES; i++) {
+		double start = _now();
+		double ms;
+
+		handle_service_action("alarm_started", ad);
+		_frame();
+		ms = (_now() - start) * 1000.0;
+		to_alarm += ms;
+		if (ms > to_alarm_max)
+			to_alarm_max = ms;
+
+		start = _now();
+		elm_object_signal_emit(ad->alarm_screen, SIGNAL_ACTION_SNOOZE, "");
+		_frame();
+		ms = (_now() - start) * 1000.0;
+		to_watch += ms;
+		if (ms > to_watch_max)
+			to_watch_max = ms;
+
+		if (is_alarm_shown) {
+			printf("transitions: snooze did not return to the watch screen\n");
+			return false;
+		}
+		if (i == 0)
+			rss_first = _rss_kb();
+	}
+
+	rss_end = _rss_kb();
+	objects_end = _objects_count(ad->win);
+	printf("transition to alarm: %.2f ms avg, %.2f ms max, until the frame is rendered\n",
+			to_alarm / SNOOZE_CYCLES, to_alarm_max);
+	printf("transition on snooze: %.2f ms avg, %.2f ms max, until the frame is rendered\n",
+			to_watch / SNOOZE_CYCLES, to_watch_max);
+	printf("rss: %ld kB before, %ld kB after 1 snooze cycle, %ld kB after %d (%+ld kB since the first)\n",
+			rss_start, rss_first, rss_end, SNOOZE_CYCLES, rss_end - rss_first);
+	printf("objects: %d in the tree before, %d after %d snooze cycles\n", objects_start, objects_end, SNOOZE_CYCLES);
+	return objects_end == objects_start;
+}
+
+/* An update draws only the new columns, so its cost must not grow with the length of the session */
+static void _bench_sparkline(appdata_s *ad)
+{
+	shared_state_s state;
+	double update_ms = 0, early_ms = 0, render_ms = 0, start, ms;
+	int i;
+
+	_tracking_set(true);
+	_frame();
+
+	for (i = 0; i < SPARKLINE_UPDATES; i++) {
+		state_page_set_last_epoch(i % 10, i % 10 / 2.0f);
+		if (!state_reader_read(&state))
+			continue;
+
+		start = _now();
+		sparkline_update(&state);
+		ms = (_now() - start) * 1000.0;
+		update_ms += ms;
+		if (i < SHARED_STATE_RING)
+			early_ms += ms;
+		render_ms += _frame();
+	}
+	printf("sparkline one epoch: update %.2f us, render %.3f ms (avg over %d updates)\n",
+			update_ms * 1000.0 / SPARKLINE_UPDATES, render_ms / SPARKLINE_UPDATES, SPARKLINE_UPDATES);
+	printf("sparkline one epoch: update %.2f us over the first %d epochs, %.2f us over the rest\n",
+			early_ms * 1000.0 / SHARED_STATE_RING, SHARED_STATE_RING,
+			(update_ms - early_ms) * 1000.0 / (SPARKLINE_UPDATES - SHARED_STATE_RING));
+
+	/* The screen was off for a while, the whole ring is new */
+	for (i = 0; i < SHARED_STATE_RING; i++)
+		state_page_set_last_epoch(i % 10, i % 10 / 2.0f);
+	if (state_reader_read(&state)) {
+		start = _now();
+		sparkline_update(&state);
+		update_ms = (_now() - start) * 1000.0;
+		printf("sparkline full ring: update %.2f us, render %.3f ms\n", update_ms * 1000.0, _frame());
+	}
+
+	_tracking_set(false);
+	_frame();
+}
+
+/* The tap shows tracking right away and the service's answer only reconciles it */
+static bool _bench_tap(appdata_s *ad)
+{
+	double feedback = 0, feedback_max = 0, confirm = 0, start, ms;
+	int confirmed = 0;
+	bool rejected;
+	int i;
+
+	for (i = 0; i < TAPS; i++) {
+		if (!_tracking_set(false)) {
+			printf("tap: tracking did not stop\n");
+			return false;
+		}
+		_frame();
+
+		start = _now();
+		elm_object_signal_emit(ad->watch_screen, SIGNAL_ACTION_START_TRACKING, "");
+		_frame();
+		ms = (_now() - start) * 1000.0;
+		feedback += ms;
+		if (ms > feedback_max)
+			feedback_max = ms;
+
+		if (_loop_until(&start_pending, false, PENDING_START_TIMEOUT + 1.0) && is_tracking) {
+			confirm += (_now() - start) * 1000.0;
+			confirmed++;
+		}
+		_frame();
+	}
+
+	printf("tap to feedback: %.2f ms avg, %.2f ms max, until the frame showing it is rendered\n",
+			feedback / TAPS, feedback_max);
+	printf("tap to confirmation: %.1f ms avg over %d of %d taps, stand-in service answers after %s ms\n",
+			confirmed ? confirm / confirmed : 0, confirmed, TAPS,
+			getenv("BENCH_SERVICE_DELAY_MS") ? getenv("BENCH_SERVICE_DELAY_MS") : "300");
+
+	/* Once with a service that rejects the start, the revert comes with its answer */
+	if (!_tracking_set(false))
+		return false;
+	standin_service_start_answer_set(STANDIN_START_REJECT);
+	start = _now();
+	elm_object_signal_emit(ad->watch_screen, SIGNAL_ACTION_START_TRACKING, "");
+	_frame();
+	_loop_until(&start_pending, false, PENDING_START_TIMEOUT + 1.0);
+	ms = (_now() - start) * 1000.0;
+	_frame();
+	rejected = !is_tracking && ms < PENDING_START_TIMEOUT * 1000.0;
+	printf("tap rejected: %s after %.0f ms\n", is_tracking ? "still tracking" : "reverted", ms);
+
+	/* Once with a service that never answers, the optimistic state has to go away on its own */
+	standin_service_start_answer_set(STANDIN_START_SILENT);
+	start = _now();
+	elm_object_signal_emit(ad->watch_screen, SIGNAL_ACTION_START_TRACKING, "");
+	_frame();
+	_loop_until(&start_pending, false, PENDING_START_TIMEOUT + 1.0);
+	ms = (_now() - start) * 1000.0;
+	_frame();
+	standin_service_start_answer_set(STANDIN_START_ACCEPT);
+	printf("tap without answer: %s after %.0f ms\n", is_tracking ? "still tracking" : "reverted", ms);
+
+	return confirmed == TAPS && rejected && !is_tracking;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *mode = argc > 1 ? argv[1] : "all";
+	bool all = strcmp(mode, "all") == 0;
+	bool ok = true;
+	appdata_s ad = {0,};
+	double start;
+
+	if (!fake_watch_app_init()) {
+		fprintf(stderr, "Failed to initialize Elementary on the buffer engine\n");
+		return 1;
+	}
+	state_page_open();
+
+	start = _now();
+	if (!app_create(FAKE_SCREEN_W, FAKE_SCREEN_H, &ad) || ad.watch_screen == NULL) {
+		fprintf(stderr, "app_create failed\n");
+		return 1;
+	}
+	s_bench.ee = ecore_evas_ecore_evas_get(evas_object_evas_get(ad.win));
+	/* Frames are rendered by _frame() only, so every one is accounted to what caused it */
+	ecore_evas_manual_render_set(s_bench.ee, EINA_TRUE);
+	evas_event_callback_add(evas_object_evas_get(ad.win), EVAS_CALLBACK_RENDER_POST, _render_post_cb, NULL);
+	_frame();
+	/* The data directory is new, so this includes rendering the digit atlas */
+	printf("create: %.1f ms to the first frame at %dx%d\n", (_now() - start) * 1000.0, FAKE_SCREEN_W, FAKE_SCREEN_H);
+
+	if (all || strcmp(mode, "ticks") == 0)
+		_bench_ticks(&ad);
+	if (all || strcmp(mode, "transitions") == 0)
+		ok &= _bench_transitions(&ad);
+	if (all || strcmp(mode, "sparkline") == 0)
+		_bench_sparkline(&ad);
+	if (all || strcmp(mode, "tap") == 0)
+		ok &= _bench_tap(&ad);
+
+	app_terminate(&ad);
+	state_page_close();
+	fake_watch_app_shutdown();
+	return ok ? 0 : 1;
+}
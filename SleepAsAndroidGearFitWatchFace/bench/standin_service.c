@@ -0,0 +1,71 @@
+/*
+ * Stand-in for the service behind service_channel.c. Commands are answered the way the service does,
+ * through the shared state record written by the service's own state_page.c, so the watch face sees
+ * the same file monitor events it gets on the device. Only the message port hop is left out.
+ */
+#include <Elementary.h>
+#include <string.h>
+#include "sleepasandroidgearfitwatchface.h"
+#include "service_channel.h"
+#include "standin_service.h"
+#include "state_page.h"
+
+/* How long the service takes from receiving start_tracking to publishing it, overridden by BENCH_SERVICE_DELAY_MS */
+#define DEFAULT_CONFIRM_DELAY_MS 300
+
+static struct standin_info {
+	service_action_cb action_received;
+	void *data;
+	Ecore_Timer *confirm_timer;
+	standin_start_e start_answer;
+} s_info = {
+	.action_received = NULL,
+	.data = NULL,
+	.confirm_timer = NULL,
+	.start_answer = STANDIN_START_ACCEPT,
+};
+
+static Eina_Bool _confirm_cb(void *data)
+{
+	s_info.confirm_timer = NULL;
+	if (s_info.start_answer == STANDIN_START_ACCEPT)
+		state_page_set_tracking(TRUE);
+	state_page_answer_start(s_info.start_answer == STANDIN_START_ACCEPT);
+	return ECORE_CALLBACK_CANCEL;
+}
+
+void service_channel_init(service_action_cb action_received, void *data)
+{
+	s_info.action_received = action_received;
+	s_info.data = data;
+}
+
+void service_channel_shutdown(void)
+{
+	if (s_info.confirm_timer) {
+		ecore_timer_del(s_info.confirm_timer);
+		s_info.confirm_timer = NULL;
+	}
+	s_info.action_received = NULL;
+}
+
+void service_channel_send(const char *command)
+{
+	const char *delay = getenv("BENCH_SERVICE_DELAY_MS");
+
+	if (strcmp(command, "start_tracking") == 0) {
+		if (s_info.start_answer != STANDIN_START_SILENT && s_info.confirm_timer == NULL)
+			s_info.confirm_timer = ecore_timer_add((delay ? atoi(delay) : DEFAULT_CONFIRM_DELAY_MS) / 1000.0, _confirm_cb, NULL);
+	} else if (strcmp(command, "snooze") == 0 || strcmp(command, "dismiss") == 0) {
+		state_page_set_alarm_active(FALSE);
+	}
+}
+
+void standin_service_start_answer_set(standin_start_e answer)
+{
+	s_info.start_answer = answer;
+}
+
+void service_channel_note_latency(const char *via, const char *sent_at)
+{
+}
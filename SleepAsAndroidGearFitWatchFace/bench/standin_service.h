@@ -0,0 +1,19 @@
+#if !defined(STANDIN_SERVICE_H_)
+#define STANDIN_SERVICE_H_
+
+typedef enum {
+	/* Publishes tracking and the answer, like a service that started */
+	STANDIN_START_ACCEPT,
+	/* Publishes a rejection, like a service whose sensor did not start */
+	STANDIN_START_REJECT,
+	/* Drops the command, like a service that is not running */
+	STANDIN_START_SILENT,
+} standin_start_e;
+
+/*
+ * @brief Sets how the stand-in service answers start_tracking
+ * @param[answer] The answer to give from now on
+ */
+void standin_service_start_answer_set(standin_start_e answer);
+
+#endif
@@ -0,0 +1,38 @@
+#if !defined(__BENCH_STUB_APP_H__)
+#define __BENCH_STUB_APP_H__
+
+/* Host stand-in for the Tizen application API, only what the watch face and the state page use */
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef struct _app_control_s *app_control_h;
+typedef struct _app_event_info_s *app_event_info_h;
+typedef struct _app_event_handler_s *app_event_handler_h;
+
+typedef enum {
+	APP_EVENT_LOW_MEMORY,
+	APP_EVENT_LOW_BATTERY,
+	APP_EVENT_LANGUAGE_CHANGED,
+	APP_EVENT_DEVICE_ORIENTATION_CHANGED,
+	APP_EVENT_REGION_FORMAT_CHANGED,
+} app_event_type_e;
+
+typedef enum {
+	APP_ERROR_NONE = 0,
+	APP_ERROR_INVALID_PARAMETER = -22,
+} app_error_e;
+
+typedef enum {
+	APP_CONTROL_ERROR_NONE = 0,
+	APP_CONTROL_ERROR_KEY_NOT_FOUND = -126,
+} app_control_error_e;
+
+typedef void (*app_event_cb)(app_event_info_h event_info, void *user_data);
+
+char *app_get_data_path(void);
+char *app_get_resource_path(void);
+int app_event_get_language(app_event_info_h event_info, char **lang);
+int app_control_get_caller(app_control_h app_control, char **id);
+int app_control_get_extra_data(app_control_h app_control, const char *key, char **value);
+
+#endif
@@ -0,0 +1,6 @@
+#if !defined(__BENCH_STUB_APP_COMMON_H__)
+#define __BENCH_STUB_APP_COMMON_H__
+
+#include <app.h>
+
+#endif
@@ -0,0 +1,4 @@
+#if !defined(__BENCH_STUB_APP_MANAGER_H__)
+#define __BENCH_STUB_APP_MANAGER_H__
+
+#endif
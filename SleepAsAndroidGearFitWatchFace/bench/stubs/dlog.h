@@ -0,0 +1,18 @@
+#if !defined(__BENCH_STUB_DLOG_H__)
+#define __BENCH_STUB_DLOG_H__
+
+/* Host stand-in for the Tizen log, messages go to stderr when BENCH_VERBOSE is set */
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef enum {
+	DLOG_DEBUG = 3,
+	DLOG_INFO,
+	DLOG_WARN,
+	DLOG_ERROR,
+} log_priority;
+
+#define dlog_print(prio, tag, ...) \
+	(getenv("BENCH_VERBOSE") ? (fprintf(stderr, "%s: ", tag), fprintf(stderr, __VA_ARGS__), fprintf(stderr, "\n")) : 0)
+
+#endif
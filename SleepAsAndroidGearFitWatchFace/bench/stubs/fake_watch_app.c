@@ -0,0 +1,166 @@
+#include <Elementary.h>
+#include <Ecore_File.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <system_settings.h>
+#include <watch_app_efl.h>
+#include "fake_watch_app.h"
+
+struct _watch_time_s {
+	struct tm tm;
+	int millisecond;
+};
+
+static struct fake_info {
+	Evas_Object *win;
+	char data_path[PATH_MAX];
+} s_info = {
+	.win = NULL,
+};
+
+bool fake_watch_app_init(void)
+{
+	/* elm_win then puts every window on an Ecore_Evas buffer canvas, nothing reaches a display */
+	setenv("ELM_ENGINE", "buffer", 1);
+	if (!elm_init(0, NULL))
+		return false;
+
+	snprintf(s_info.data_path, sizeof(s_info.data_path), "%s/watchface_bench_XXXXXX", getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+	if (mkdtemp(s_info.data_path) == NULL) {
+		elm_shutdown();
+		return false;
+	}
+	strcat(s_info.data_path, "/");
+	return true;
+}
+
+void fake_watch_app_shutdown(void)
+{
+	if (s_info.win) {
+		evas_object_del(s_info.win);
+		s_info.win = NULL;
+	}
+	ecore_file_recursive_rm(s_info.data_path);
+	elm_shutdown();
+}
+
+int watch_app_get_elm_win(Evas_Object **win)
+{
+	if (s_info.win == NULL) {
+		s_info.win = elm_win_add(NULL, "watchface_bench", ELM_WIN_BASIC);
+		if (s_info.win == NULL)
+			return APP_ERROR_INVALID_PARAMETER;
+		evas_object_resize(s_info.win, FAKE_SCREEN_W, FAKE_SCREEN_H);
+	}
+
+	*win = s_info.win;
+	return APP_ERROR_NONE;
+}
+
+int watch_app_main(int argc, char **argv, watch_app_lifecycle_callback_s *callback, void *user_data)
+{
+	/* The benchmark drives the lifecycle callbacks itself */
+	return APP_ERROR_INVALID_PARAMETER;
+}
+
+void watch_app_exit(void)
+{
+}
+
+int watch_app_add_event_handler(app_event_handler_h *event_handler, app_event_type_e event_type, app_event_cb callback, void *user_data)
+{
+	*event_handler = NULL;
+	return APP_ERROR_NONE;
+}
+
+watch_time_h fake_watch_time_new(int hour24, int minute, int second)
+{
+	watch_time_h watch_time = calloc(1, sizeof(*watch_time));
+
+	watch_time->tm.tm_hour = hour24;
+	watch_time->tm.tm_min = minute;
+	watch_time->tm.tm_sec = second;
+	return watch_time;
+}
+
+int watch_time_get_current_time(watch_time_h *watch_time)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	*watch_time = calloc(1, sizeof(**watch_time));
+	localtime_r(&tv.tv_sec, &(*watch_time)->tm);
+	(*watch_time)->millisecond = tv.tv_usec / 1000;
+	return APP_ERROR_NONE;
+}
+
+int watch_time_delete(watch_time_h watch_time)
+{
+	free(watch_time);
+	return APP_ERROR_NONE;
+}
+
+int watch_time_get_hour(watch_time_h watch_time, int *hour)
+{
+	*hour = watch_time->tm.tm_hour % 12 ? watch_time->tm.tm_hour % 12 : 12;
+	return APP_ERROR_NONE;
+}
+
+int watch_time_get_hour24(watch_time_h watch_time, int *hour24)
+{
+	*hour24 = watch_time->tm.tm_hour;
+	return APP_ERROR_NONE;
+}
+
+int watch_time_get_minute(watch_time_h watch_time, int *minute)
+{
+	*minute = watch_time->tm.tm_min;
+	return APP_ERROR_NONE;
+}
+
+int watch_time_get_second(watch_time_h watch_time, int *second)
+{
+	*second = watch_time->tm.tm_sec;
+	return APP_ERROR_NONE;
+}
+
+int watch_time_get_millisecond(watch_time_h watch_time, int *millisecond)
+{
+	*millisecond = watch_time->millisecond;
+	return APP_ERROR_NONE;
+}
+
+char *app_get_data_path(void)
+{
+	return strdup(s_info.data_path);
+}
+
+char *app_get_resource_path(void)
+{
+	return strdup(BENCH_RES_DIR);
+}
+
+int app_event_get_language(app_event_info_h event_info, char **lang)
+{
+	*lang = NULL;
+	return APP_ERROR_INVALID_PARAMETER;
+}
+
+int app_control_get_caller(app_control_h app_control, char **id)
+{
+	*id = NULL;
+	return APP_CONTROL_ERROR_KEY_NOT_FOUND;
+}
+
+int app_control_get_extra_data(app_control_h app_control, const char *key, char **value)
+{
+	*value = NULL;
+	return APP_CONTROL_ERROR_KEY_NOT_FOUND;
+}
+
+int system_settings_get_value_string(system_settings_key_e key, char **value)
+{
+	*value = NULL;
+	return APP_ERROR_INVALID_PARAMETER;
+}
@@ -0,0 +1,26 @@
+#if !defined(__BENCH_FAKE_WATCH_APP_H__)
+#define __BENCH_FAKE_WATCH_APP_H__
+
+#include <watch_app.h>
+
+/* Gear Fit2 screen, the size the framework hands to app_create */
+#define FAKE_SCREEN_W 216
+#define FAKE_SCREEN_H 432
+
+/*
+ * @brief Starts Elementary on the buffer engine and creates a scratch data directory
+ * @return false when Elementary could not be initialized
+ */
+bool fake_watch_app_init(void);
+
+/*
+ * @brief Shuts Elementary down and removes the scratch data directory
+ */
+void fake_watch_app_shutdown(void);
+
+/*
+ * @brief A time handle for the given wall time, free it with watch_time_delete()
+ */
+watch_time_h fake_watch_time_new(int hour24, int minute, int second);
+
+#endif
@@ -0,0 +1,8 @@
+#if !defined(__BENCH_STUB_WATCH_APP_EFL_H__)
+#define __BENCH_STUB_WATCH_APP_EFL_H__
+
+#include <Elementary.h>
+
+int watch_app_get_elm_win(Evas_Object **win);
+
+#endif
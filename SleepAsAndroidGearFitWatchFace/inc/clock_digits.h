@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#if !defined(CLOCK_DIGITS_H_)
+#define CLOCK_DIGITS_H_
+
+#include <Elementary.h>
+#include "digit_atlas.h"
+
+/* HH:MM clock made of fixed-width cells, a change of the time only touches the cells that differ */
+typedef struct clock_digits clock_digits_s;
+
+clock_digits_s *clock_digits_add(Evas_Object *parent, digit_palette_e palette);
+Evas_Object *clock_digits_object_get(clock_digits_s *clock);
+void clock_digits_set(clock_digits_s *clock, int hour24, int minute);
+void clock_digits_palette_set(clock_digits_s *clock, digit_palette_e palette);
+void clock_digits_del(clock_digits_s *clock);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#if !defined(DIGIT_ATLAS_H_)
+#define DIGIT_ATLAS_H_
+
+#include <stdbool.h>
+
+/* Glyph cell sizes, the atlas is rendered at exactly these so cells show it unscaled */
+#define DIGIT_CELL_W 32
+#define COLON_CELL_W 16
+#define CELL_H 64
+
+typedef enum {
+	DIGIT_PALETTE_NORMAL,
+	DIGIT_PALETTE_AMBIENT,
+	DIGIT_PALETTE_ALARM,
+	DIGIT_PALETTE_COUNT,
+} digit_palette_e;
+
+bool digit_atlas_prepare(void);
+const char *digit_atlas_path_get(digit_palette_e palette, char c);
+void digit_palette_color_get(digit_palette_e palette, int *r, int *g, int *b);
+
+#endif
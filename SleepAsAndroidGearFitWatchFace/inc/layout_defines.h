@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#if !defined(LAYOUT_DEFINES_H_)
+#define LAYOUT_DEFINES_H_
+
+/* Shared by res/edje/main.edc and the C code, keep it to plain defines */
+
+#define GROUP_WATCH "sleep/watch"
+#define GROUP_ALARM "sleep/alarm"
+
+#define PART_CLOCK "clock"
+#define PART_SPARKLINE "sparkline"
+#define PART_TRACK_BG "track_bg"
+#define PART_TRACK_TEXT "track_text"
+#define PART_DISMISS_BG "dismiss_bg"
+#define PART_SNOOZE_BG "snooze_bg"
+
+/* C -> edje */
+#define SIGNAL_TRACKING_ON "state,tracking,on"
+#define SIGNAL_TRACKING_OFF "state,tracking,off"
+
+/* edje -> C */
+#define SIGNAL_ACTION_START_TRACKING "action,start_tracking"
+#define SIGNAL_ACTION_DISMISS "action,dismiss"
+#define SIGNAL_ACTION_SNOOZE "action,snooze"
+
+#endif
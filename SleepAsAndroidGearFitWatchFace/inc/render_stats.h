@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#if !defined(RENDER_STATS_H_)
+#define RENDER_STATS_H_
+
+#include <Elementary.h>
+
+void render_stats_init(Evas_Object *win);
+void render_stats_shutdown(void);
+void render_stats_tick_begin(const char *state);
+void render_stats_tick_end(void);
+void render_stats_feedback_begin(const char *what);
+void render_stats_log(void);
+void render_stats_log_objects(Evas_Object *root);
+
+#endif
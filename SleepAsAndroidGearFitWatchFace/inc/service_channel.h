@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(SERVICE_CHANNEL_H_)
+#define SERVICE_CHANNEL_H_
+
+#include <app.h>
+
+#define SERVICE_APP_ID "com.urbandroid.sleep.gearfit.service"
+/* Must match the ports registered by the service */
+#define SERVICE_PORT "sleep_service_port"
+#define WATCHFACE_PORT "sleep_watchface_port"
+
+#define KEY_ACTION "app_action"
+#define KEY_SENT_AT "sent_at"
+
+typedef void (*service_action_cb)(const char *action, void *data);
+
+void service_channel_init(service_action_cb action_received, void *data);
+void service_channel_shutdown(void);
+void service_channel_send(const char *command);
+void service_channel_note_latency(const char *via, const char *sent_at);
+
+#endif
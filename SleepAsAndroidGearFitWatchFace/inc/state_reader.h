@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(STATE_READER_H_)
+#define STATE_READER_H_
+
+#include <stdbool.h>
+#include "shared_state.h"
+
+typedef void (*state_changed_cb)(const shared_state_s *state, void *data);
+
+bool state_reader_init(state_changed_cb state_changed, void *data);
+bool state_reader_read(shared_state_s *state);
+void state_reader_shutdown(void);
+
+#endif
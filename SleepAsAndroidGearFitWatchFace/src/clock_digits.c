@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <Elementary.h>
+#include "sleepasandroidgearfitwatchface.h"
+#include "clock_digits.h"
+
+/* H H : M M */
+#define CELL_COUNT 5
+#define COLON_CELL 2
+
+struct clock_digits {
+	Evas_Object *box;
+	Evas_Object *cell[CELL_COUNT];
+	/* Cells are glyph images from the digit atlas, labels when the atlas could not be prepared */
+	bool images;
+	digit_palette_e palette;
+	/* Character each cell shows, 0 until it was set the first time */
+	char shown[CELL_COUNT];
+};
+
+static void _cell_set(clock_digits_s *clock, int idx, char c)
+{
+	char markup[64];
+
+	if (clock->shown[idx] == c)
+		return;
+
+	if (clock->images) {
+		evas_object_image_file_set(clock->cell[idx], digit_atlas_path_get(clock->palette, c), NULL);
+	} else {
+		snprintf(markup, sizeof(markup), "<align=center valign=center font_size=50>%c</align>", c);
+		elm_object_text_set(clock->cell[idx], markup);
+	}
+	clock->shown[idx] = c;
+}
+
+static Evas_Object *_cell_add(clock_digits_s *clock, int idx)
+{
+	const int w = idx == COLON_CELL ? COLON_CELL_W : DIGIT_CELL_W;
+	Evas_Object *cell;
+
+	if (clock->images) {
+		cell = evas_object_image_filled_add(evas_object_evas_get(clock->box));
+	} else {
+		int r, g, b;
+		digit_palette_color_get(clock->palette, &r, &g, &b);
+		cell = elm_label_add(clock->box);
+		evas_object_color_set(cell, r, g, b, 255);
+	}
+	evas_object_size_hint_min_set(cell, w, CELL_H);
+	evas_object_size_hint_max_set(cell, w, CELL_H);
+	return cell;
+}
+
+/*
+ * @brief Creates the clock cells, as glyph images when the digit atlas is prepared
+ * @param[parent] Parent object, the returned box has to be packed by the caller
+ * @param[palette] Initial palette
+ */
+clock_digits_s *clock_digits_add(Evas_Object *parent, digit_palette_e palette)
+{
+	clock_digits_s *clock = calloc(1, sizeof(clock_digits_s));
+	int i;
+
+	if (clock == NULL) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "failed to allocate clock.");
+		return NULL;
+	}
+
+	clock->box = elm_box_add(parent);
+	elm_box_horizontal_set(clock->box, EINA_TRUE);
+	evas_object_size_hint_weight_set(clock->box, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
+	evas_object_size_hint_align_set(clock->box, 0.5, 0.5);
+
+	clock->images = digit_atlas_path_get(palette, ':') != NULL;
+	clock->palette = palette;
+
+	for (i = 0; i < CELL_COUNT; i++) {
+		clock->cell[i] = _cell_add(clock, i);
+		elm_box_pack_end(clock->box, clock->cell[i]);
+		evas_object_show(clock->cell[i]);
+	}
+	_cell_set(clock, COLON_CELL, ':');
+	evas_object_show(clock->box);
+
+	return clock;
+}
+
+Evas_Object *clock_digits_object_get(clock_digits_s *clock)
+{
+	return clock->box;
+}
+
+/*
+ * @brief Shows the given time, a usual minute change re-lays out one cell, an hour change up to four
+ */
+void clock_digits_set(clock_digits_s *clock, int hour24, int minute)
+{
+	if (clock == NULL)
+		return;
+
+	_cell_set(clock, 0, '0' + hour24 / 10);
+	_cell_set(clock, 1, '0' + hour24 % 10);
+	_cell_set(clock, 3, '0' + minute / 10);
+	_cell_set(clock, 4, '0' + minute % 10);
+}
+
+/*
+ * @brief Switches the palette, all cells are redrawn with the same characters
+ */
+void clock_digits_palette_set(clock_digits_s *clock, digit_palette_e palette)
+{
+	char shown[CELL_COUNT];
+	int i;
+
+	if (clock == NULL || clock->palette == palette)
+		return;
+
+	clock->palette = palette;
+	memcpy(shown, clock->shown, sizeof(shown));
+	memset(clock->shown, 0, sizeof(clock->shown));
+	for (i = 0; i < CELL_COUNT; i++) {
+		if (!clock->images) {
+			int r, g, b;
+			digit_palette_color_get(palette, &r, &g, &b);
+			evas_object_color_set(clock->cell[i], r, g, b, 255);
+		}
+		if (shown[i])
+			_cell_set(clock, i, shown[i]);
+	}
+}
+
+void clock_digits_del(clock_digits_s *clock)
+{
+	if (clock == NULL)
+		return;
+
+	evas_object_del(clock->box);
+	free(clock);
+}
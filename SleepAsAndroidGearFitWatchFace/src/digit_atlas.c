@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <Ecore_Evas.h>
+#include <Ecore_File.h>
+#include <Elementary.h>
+#include "sleepasandroidgearfitwatchface.h"
+#include "digit_atlas.h"
+
+/* Bump when glyph size, font or palettes change, old files are simply not looked at anymore */
+#define ATLAS_VERSION 1
+#define GLYPH_FONT "Tizen:style=Regular"
+#define GLYPH_SIZE 50
+#define GLYPHS "0123456789:"
+#define GLYPH_COUNT 11
+
+static const struct {
+	int r, g, b;
+} palettes[DIGIT_PALETTE_COUNT] = {
+	[DIGIT_PALETTE_NORMAL] = { 230, 230, 230 },
+	[DIGIT_PALETTE_AMBIENT] = { 140, 140, 140 },
+	[DIGIT_PALETTE_ALARM] = { 30, 30, 30 },
+};
+
+static struct atlas_info {
+	bool ready;
+	char paths[DIGIT_PALETTE_COUNT][GLYPH_COUNT][PATH_MAX];
+} s_info = {
+	.ready = false,
+};
+
+static int _glyph_index(char c)
+{
+	const char *p = strchr(GLYPHS, c);
+	return (p && c) ? p - GLYPHS : -1;
+}
+
+static bool _glyph_render(Ecore_Evas *ee, Evas_Object *text, digit_palette_e palette, int idx)
+{
+	Evas *evas = ecore_evas_get(ee);
+	char str[2] = { GLYPHS[idx], 0 };
+	int w = GLYPHS[idx] == ':' ? COLON_CELL_W : DIGIT_CELL_W;
+	int tw, th;
+	bool saved;
+
+	ecore_evas_resize(ee, w, CELL_H);
+	evas_object_color_set(text, palettes[palette].r, palettes[palette].g, palettes[palette].b, 255);
+	evas_object_text_text_set(text, str);
+	evas_object_geometry_get(text, NULL, NULL, &tw, &th);
+	evas_object_move(text, (w - tw) / 2, (CELL_H - th) / 2);
+	ecore_evas_manual_render(ee);
+
+	const void *pixels = ecore_evas_buffer_pixels_get(ee);
+	if (pixels == NULL)
+		return false;
+
+	Evas_Object *img = evas_object_image_add(evas);
+	evas_object_image_alpha_set(img, EINA_TRUE);
+	evas_object_image_size_set(img, w, CELL_H);
+	evas_object_image_data_copy_set(img, (void *)pixels);
+	saved = evas_object_image_save(img, s_info.paths[palette][idx], NULL, "compress=1");
+	evas_object_del(img);
+
+	if (!saved)
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Failed to save glyph %s", s_info.paths[palette][idx]);
+	return saved;
+}
+
+/* Renders the glyphs into PNGs once, this is the only place the clock still needs the font engine */
+static bool _atlas_render(void)
+{
+	Ecore_Evas *ee;
+	Evas_Object *text;
+	bool ok = true;
+	int palette, idx;
+
+	ecore_evas_init();
+	ee = ecore_evas_buffer_new(DIGIT_CELL_W, CELL_H);
+	if (ee == NULL) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Failed to create buffer canvas for the digit atlas");
+		ecore_evas_shutdown();
+		return false;
+	}
+	ecore_evas_alpha_set(ee, EINA_TRUE);
+	ecore_evas_show(ee);
+
+	text = evas_object_text_add(ecore_evas_get(ee));
+	evas_object_text_font_set(text, GLYPH_FONT, GLYPH_SIZE);
+	evas_object_show(text);
+
+	for (palette = 0; palette < DIGIT_PALETTE_COUNT && ok; palette++)
+		for (idx = 0; idx < GLYPH_COUNT && ok; idx++)
+			if (!ecore_file_exists(s_info.paths[palette][idx]))
+				ok = _glyph_render(ee, text, palette, idx);
+
+	ecore_evas_free(ee);
+	ecore_evas_shutdown();
+	return ok;
+}
+
+/*
+ * @brief Makes sure the glyph images exist in the data directory, rendering the missing ones
+ * @return false when the clock has to fall back to text
+ */
+bool digit_atlas_prepare(void)
+{
+	char *data_path;
+	bool complete = true;
+	int palette, idx;
+	double start = ecore_time_get();
+
+	if (s_info.ready)
+		return true;
+
+	data_path = app_get_data_path();
+	if (data_path == NULL) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: No data path, digit atlas not available");
+		return false;
+	}
+
+	for (palette = 0; palette < DIGIT_PALETTE_COUNT; palette++) {
+		for (idx = 0; idx < GLYPH_COUNT; idx++) {
+			snprintf(s_info.paths[palette][idx], PATH_MAX, "%sdigits_v%d_%d_%d.png", data_path, ATLAS_VERSION, palette, idx);
+			if (complete && !ecore_file_exists(s_info.paths[palette][idx]))
+				complete = false;
+		}
+	}
+	free(data_path);
+
+	s_info.ready = complete || _atlas_render();
+	dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Digit atlas %s in %.1f ms",
+			!s_info.ready ? "failed" : complete ? "loaded from cache" : "rendered",
+			(ecore_time_get() - start) * 1000.0);
+	return s_info.ready;
+}
+
+/*
+ * @brief Image file of a glyph
+ * @return NULL when the atlas is not available
+ */
+const char *digit_atlas_path_get(digit_palette_e palette, char c)
+{
+	int idx = _glyph_index(c);
+
+	if (!s_info.ready || idx < 0 || palette >= DIGIT_PALETTE_COUNT)
+		return NULL;
+
+	return s_info.paths[palette][idx];
+}
+
+void digit_palette_color_get(digit_palette_e palette, int *r, int *g, int *b)
+{
+	*r = palettes[palette].r;
+	*g = palettes[palette].g;
+	*b = palettes[palette].b;
+}
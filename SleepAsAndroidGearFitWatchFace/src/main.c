@@ -19,79 +19,112 @@
 #include <watch_app.h>
 #include "sleepasandroidgearfitwatchface.h"
 #include "view_defines.h"
+#include "layout_defines.h"
+#include "service_channel.h"
+#include "state_reader.h"
+#include "render_stats.h"
+#include "clock_digits.h"
+#include "sparkline.h"
 #include <app_manager.h>
 
-#define MAIN_EDJ "icon/main.edj"
+#define MAIN_EDJ "edje/main.edj"
 
 
 typedef struct appdata {
 	Evas_Object *win;
 	Evas_Object *conform;
-	Evas_Object *nf;
-	Evas_Object *label_watch_time;
-	Evas_Object *label_alarm_time;
-	Evas_Object *label_tracking;
-	Evas_Object *bg_snz;
-	Evas_Object *bg_dis;
-	Evas_Object *bg_track;
+	/* Both screens are built once and stacked in this table, only one of them is visible */
+	Evas_Object *screens;
+	Evas_Object *watch_screen;
+	Evas_Object *alarm_screen;
+	clock_digits_s *watch_clock;
+	clock_digits_s *alarm_clock;
 
 } appdata_s;
 
 bool is_tracking = false;
+bool is_alarm_shown = false;
+// Till when the service has tracking paused (seconds since epoch), 0 when not paused.
+time_t paused_till = 0;
 int g_width;
 int g_height;
 
 #define TEXT_BUF_SIZE 256
-#define IMAGE_PATH "images/unnamed.png"
-#define ServiceID "com.urbandroid.sleep.gearfit.service"
+
+/* A tap asked the service to start tracking and the screen already shows it, the service has not answered yet.
+ * The timeout only covers a service that is not running to answer at all. */
+#define PENDING_START_TIMEOUT 10.0
+static bool start_pending = false;
+static Ecore_Timer *pending_start_timer = NULL;
+static double pending_start_at = 0;
+/* start_answers of the state record when the tap was sent, the answer to it moves the counter */
+static uint32_t pending_start_answers = 0;
+
+/* Screen switches since start and the time they took, logged on every switch */
+static int transitions = 0;
+static double transitions_total_ms = 0;
 
 static void create_base_gui(appdata_s *ad, int width, int height);
-static void watchface_gui(appdata_s *ad);
+static void show_watch_screen(appdata_s *ad);
 
 static void
 update_watch(appdata_s *ad, watch_time_h watch_time, int ambient)
 {
-	char watch_text[TEXT_BUF_SIZE];
-	int hour24, minute, second;
+	int hour24, minute;
 
 	if (watch_time == NULL)
 		return;
 
 	watch_time_get_hour24(watch_time, &hour24);
 	watch_time_get_minute(watch_time, &minute);
-//	watch_time_get_second(watch_time, &second);
-//	if (!ambient) {
-//		snprintf(watch_text, TEXT_BUF_SIZE, "<align=center valign=center font_size=50><br/>%02d:%02d:%02d<br/></align>",
-//				hour24, minute, second);
-//	} else {
-		snprintf(watch_text, TEXT_BUF_SIZE, "<align=center valign=center font_size=50><br/>%02d:%02d<br/></align>",
-				hour24, minute);
-//	}
-	elm_object_text_set(ad->label_alarm_time, watch_text);
-	elm_object_text_set(ad->label_watch_time, watch_text);
+
+	/* Only the visible clock, the hidden one is brought up to date when its screen is switched to */
+	clock_digits_set(is_alarm_shown ? ad->alarm_clock : ad->watch_clock, hour24, minute);
+}
+
+static void update_watch_now(appdata_s *ad)
+{
+	watch_time_h watch_time = NULL;
+	int ret = watch_time_get_current_time(&watch_time);
+	if (ret != APP_ERROR_NONE)
+		dlog_print(DLOG_ERROR, LOG_TAG, "failed to get current time. err = %d", ret);
+
+	update_watch(ad, watch_time, 0);
+	watch_time_delete(watch_time);
 }
 
 static void return_to_base_UI(appdata_s *ad){
 	dlog_print(DLOG_INFO, LOG_TAG, "Watchface: Return to Base GUI");
-	elm_naviframe_item_pop(ad->nf);
-	watchface_gui(ad);
+	show_watch_screen(ad);
 }
 
 
+static void pause_label_update(appdata_s *ad){
+	char text[TEXT_BUF_SIZE];
+	time_t now = time(NULL);
+
+	if (start_pending) {
+		elm_object_part_text_set(ad->watch_screen, PART_TRACK_TEXT, "Starting...");
+	} else if (paused_till > now) {
+		// Round up, "0 min" while still paused would look broken.
+		snprintf(text, TEXT_BUF_SIZE, "Paused<br/>%d min", (int)((paused_till - now + 59) / 60));
+		elm_object_part_text_set(ad->watch_screen, PART_TRACK_TEXT, text);
+	} else {
+		elm_object_part_text_set(ad->watch_screen, PART_TRACK_TEXT, "Tracking...");
+	}
+}
+
 static void tracking_updater(appdata_s *ad, bool tracking){
 	is_tracking = tracking;
 
 	if (is_tracking){
 		dlog_print(DLOG_INFO, LOG_TAG, "UI: Tracking on");
-		elm_bg_color_set(ad->bg_track,54,57,59);
-		evas_object_size_hint_padding_set(ad->label_tracking,0,0,70,0);
-		elm_object_text_set(ad->label_tracking,"<align=center valign=middle>Tracking...</align>");
+		elm_object_signal_emit(ad->watch_screen, SIGNAL_TRACKING_ON, "");
+		pause_label_update(ad);
 	} else{
 		dlog_print(DLOG_INFO, LOG_TAG, "UI: Tracking off");
-		elm_bg_color_set(ad->bg_track,3,25,39);
-
-		evas_object_size_hint_padding_set(ad->label_tracking,0,0,30,0);
-		elm_object_text_set(ad->label_tracking,"<align=center valign=middle>2x tap<br/>to start<br/>tracking</align>");
+		elm_object_signal_emit(ad->watch_screen, SIGNAL_TRACKING_OFF, "");
+		elm_object_part_text_set(ad->watch_screen, PART_TRACK_TEXT, "2x tap<br/>to start<br/>tracking");
 	}
 
 }
@@ -114,81 +147,69 @@ static char *_create_resource_path(const char *file_name)
 }
 
 static void send_service_command(const char* command) {
-	app_control_h app_control;
-	if (app_control_create(&app_control) == APP_CONTROL_ERROR_NONE) {
-		int res1 = 0, res2 = 0, res3 = 0;
-		if (((res1 = app_control_set_app_id(app_control, "com.urbandroid.sleep.gearfit.service")) == APP_CONTROL_ERROR_NONE)
-				&& ((res2 = app_control_add_extra_data(app_control, "app_action", command)) == APP_CONTROL_ERROR_NONE)
-				&& ((res3 = app_control_send_launch_request(app_control, NULL, NULL)) == APP_CONTROL_ERROR_NONE)) {
-			dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: App command request sent: %s", command);
-		} else {
-			dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: App command request sending failed! Err: %d %d %d", res1, res2, res3);
-		}
-		if (app_control_destroy(app_control) == APP_CONTROL_ERROR_NONE) {
-			dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: App control destroyed.");
-		}
-	} else {
-		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: App control creation failed!");
-	}
+	service_channel_send(command);
 }
 
 /*
-static Evas_Event_Flags
-tracking_button_clicked(void *data, void *event_info)
+ * @brief Ends the optimistic tracking state, either confirmed by the service or rejected or given up on
+ * @param[ad] The application data
+ * @param[confirmed] The service published tracking
+ */
+static void pending_start_finish(appdata_s *ad, bool confirmed)
 {
-	dlog_print(DLOG_INFO, LOG_TAG,"Watchface: Tracking Button Double Clicked");
+	if (!start_pending)
+		return;
 
-	//tracking_updater(data, !is_tracking );
-	send_service_command("start_tracking");
-	return EVAS_EVENT_FLAG_ON_HOLD;
+	start_pending = false;
+	if (pending_start_timer) {
+		ecore_timer_del(pending_start_timer);
+		pending_start_timer = NULL;
+	}
+	dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Tracking start %s after %.0f ms",
+			confirmed ? "confirmed" : "not confirmed, reverting", (ecore_time_get() - pending_start_at) * 1000.0);
+
+	if (!confirmed) {
+		shared_state_s state;
+		tracking_updater(ad, state_reader_read(&state) && state.tracking);
+	} else {
+		tracking_updater(ad, true);
+	}
 }
-*/
 
-static Evas_Event_Flags
-tracking_button_onetap_start(void *data, void *event_info)
+static Eina_Bool pending_start_timeout_cb(void *data)
 {
-	appdata_s *ad = data;
-	int t_x,t_y,t_w,t_h; // s for snooze, d for dismiss
-	evas_object_geometry_get(ad->bg_track,&t_x,&t_y,&t_w,&t_h);
-	Elm_Gesture_Taps_Info *p = (Elm_Gesture_Taps_Info *)event_info;
-	if (p->y > t_y){ // on dismiss
-		dlog_print(DLOG_INFO, LOG_TAG,"Watchface: Tracking Button Once Clicked");
-		elm_bg_color_set(ad->bg_track,255,255,255);
-	}
-	return EVAS_EVENT_FLAG_ON_HOLD;
+	pending_start_timer = NULL;
+	pending_start_finish(data, false);
+	return ECORE_CALLBACK_CANCEL;
 }
 
-static Evas_Event_Flags
-tracking_button_clicked(void *data, void *event_info)
+static void
+tracking_double_tapped(void *data, Evas_Object *obj, const char *emission, const char *source)
 {
 	appdata_s *ad = data;
 
-	int t_x,t_y,t_w,t_h; // s for snooze, d for dismiss
-	evas_object_geometry_get(ad->bg_track,&t_x,&t_y,&t_w,&t_h);
-//	dlog_print(DLOG_INFO,LOG_TAG, " bg_track coords: %d %d %d %d",t_x,t_y,t_w,t_h);
-
-	Elm_Gesture_Taps_Info *p = (Elm_Gesture_Taps_Info *)event_info;
-//	dlog_print(DLOG_INFO, LOG_TAG,"N tap started <%p> x,y=<%d,%d> count=<%d> timestamp=<%d> \n",
-//		           event_info, p->x, p->y, p->n, p->timestamp);
-
-
-	//	if (p->x > 0 && p->y > 0 && p->x < g_width && p->y < g_height){}
-	if (p->y > t_y){ // on dismiss
-		dlog_print(DLOG_INFO, LOG_TAG,"Watchface: Tracking Button Double Clicked");
-
-		//tracking_updater(data, !is_tracking );
-		send_service_command("start_tracking");
-	}else{
-		dlog_print(DLOG_INFO,LOG_TAG, "Not Tracking Button");
+	dlog_print(DLOG_INFO, LOG_TAG,"Watchface: Tracking Button Double Clicked");
+	if (start_pending) {
+		dlog_print(DLOG_INFO, LOG_TAG,"Watchface: Tracking start already pending");
+		return;
 	}
 
+	if (!is_tracking) {
+		shared_state_s state;
 
-	return EVAS_EVENT_FLAG_ON_HOLD;
+		/* Show it right away, the service answers through the state record */
+		pending_start_answers = state_reader_read(&state) ? state.start_answers : 0;
+		start_pending = true;
+		pending_start_at = ecore_time_get();
+		pending_start_timer = ecore_timer_add(PENDING_START_TIMEOUT, pending_start_timeout_cb, ad);
+		render_stats_feedback_begin("Tap to tracking");
+		tracking_updater(ad, true);
+	}
+	send_service_command("start_tracking");
 }
 
-
 static void
-snz_button_clicked(void *data)
+snz_button_clicked(void *data, Evas_Object *obj, const char *emission, const char *source)
 {
 	dlog_print(DLOG_INFO, LOG_TAG,"Watchface: Snooze Clicked");
 	send_service_command("snooze");
@@ -196,42 +217,13 @@ snz_button_clicked(void *data)
 }
 
 static void
-dis_button_clicked(void *data)
+dis_button_clicked(void *data, Evas_Object *obj, const char *emission, const char *source)
 {
 	dlog_print(DLOG_INFO, LOG_TAG,"Watchface: Dismiss Clicked");
 	send_service_command("dismiss");
 //	return_to_base_UI(data);
 }
 
-static Evas_Event_Flags
-alarm_touch_event(void *data, void *event_info)
-{
-	appdata_s *ad = data;
-
-	Elm_Gesture_Taps_Info *p = (Elm_Gesture_Taps_Info *)event_info;
-	//	dlog_print(DLOG_INFO, LOG_TAG,"N tap started <%p> x,y=<%d,%d> count=<%d> timestamp=<%d> \n",
-	//	           event_info, p->x, p->y, p->n, p->timestamp);
-
-	int s_x,s_y,s_w,s_h; // s for snooze, d for dismiss
-	int d_x,d_y,d_w,d_h;
-	evas_object_geometry_get(ad->bg_snz,&s_x,&s_y,&s_w,&s_h);
-	evas_object_geometry_get(ad->bg_dis,&d_x,&d_y,&d_w,&d_h);
-	//	dlog_print(DLOG_INFO,LOG_TAG, " bg_snz coords: %d %d %d %d",s_x,s_y,s_w,s_h);
-		dlog_print(DLOG_INFO,LOG_TAG, " bg_dis coords: %d %d %d %d",d_x,d_y,d_w,d_h);
-
-	//	if (p->x > 0 && p->y > 0 && p->x < g_width && p->y < g_height){}
-	if (p->y < d_h){ // on dismiss
-		dis_button_clicked(ad);
-	}else if(p->y > s_y){
-		snz_button_clicked(ad);
-	}else{
-		dlog_print(DLOG_INFO,LOG_TAG, "Not dismiss or snooze click");
-	}
-
-
-	return EVAS_EVENT_FLAG_ON_HOLD;
-}
-
 
 
 static void
@@ -257,163 +249,153 @@ create_base_gui(appdata_s *ad, int width, int height)
 	elm_win_resize_object_add(ad->win, ad->conform);
 	evas_object_show(ad->conform);
 
-	/* Naviframe */
-	ad->nf = elm_naviframe_add(ad->conform);
-	elm_object_content_set(ad->conform, ad->nf);
-	evas_object_show(ad->nf);
+	/* Screens */
+	ad->screens = elm_table_add(ad->conform);
+	evas_object_size_hint_weight_set(ad->screens, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
+	evas_object_size_hint_align_set(ad->screens, EVAS_HINT_FILL, EVAS_HINT_FILL);
+	elm_object_content_set(ad->conform, ad->screens);
+	evas_object_show(ad->screens);
 
 	dlog_print(DLOG_INFO, LOG_TAG, "Finished Base GUI");
 }
 
 
-static void
-watchface_gui(appdata_s *ad)
+/*
+ * @brief Creates a screen from a group of the compiled theme, layout and colors all come from main.edc
+ * @param[ad] The application data
+ * @param[group] Group name in the theme
+ */
+static Evas_Object *
+create_screen_layout(appdata_s *ad, const char *group)
 {
-	dlog_print(DLOG_INFO, LOG_TAG, "Started Watch Face GUI");
+	Evas_Object *layout = elm_layout_add(ad->screens);
+	char *edj_path = _create_resource_path(MAIN_EDJ);
 
-	Evas_Object *watch_bg = elm_bg_add(ad->nf);
-	elm_bg_color_set(watch_bg,20,20,20);
-	evas_object_show(watch_bg);
-
-
-	Evas_Object *table_watch = elm_table_add(ad->nf);
-	evas_object_size_hint_weight_set(table_watch,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	evas_object_size_hint_align_set(table_watch,EVAS_HINT_FILL, EVAS_HINT_FILL);
-	evas_object_show(table_watch);
-
-	elm_object_content_set(watch_bg,table_watch);
-
-
-	/* Label Time */
-	ad->label_watch_time = elm_label_add(table_watch);
-	evas_object_color_set(ad->label_watch_time,230,230,230,255);
-	elm_object_text_set(ad->label_watch_time,"<align=center valign=top> TIME </align> ");
-	evas_object_size_hint_min_set(ad->label_watch_time, g_width, g_height*.75);
-	evas_object_size_hint_align_set(ad->label_watch_time,EVAS_HINT_FILL,EVAS_HINT_FILL);
-	evas_object_size_hint_weight_set(ad->label_watch_time,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	elm_table_pack(table_watch,ad->label_watch_time,0,0,1,1);
-	evas_object_show(ad->label_watch_time);
-
-	/* Tracking Background*/
-	ad->bg_track = elm_bg_add(table_watch);
-	elm_bg_color_set(ad->bg_track,3,25,39);
-	evas_object_size_hint_min_set(ad->bg_track, g_width, g_height*.25);
-	evas_object_size_hint_weight_set(ad->bg_track,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	evas_object_size_hint_align_set(ad->bg_track,EVAS_HINT_FILL, EVAS_HINT_FILL);
-	evas_object_show(ad->bg_track);
-	elm_table_pack(table_watch,ad->bg_track,0,1,1,1);
-
-	/* Label Tracking */
-	ad->label_tracking = elm_label_add(table_watch);
-	elm_object_content_set(ad->bg_track,ad->label_tracking);
-	evas_object_size_hint_align_set(ad->label_tracking,EVAS_HINT_FILL,EVAS_HINT_FILL);
-	evas_object_size_hint_weight_set(ad->label_tracking,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	//elm_object_text_set(ad->label_tracking,"<align=center valign=middle> <br/>Double Tap to Track<br/></align> ");
-	elm_object_text_set(ad->label_tracking,"<align=center valign=middle>2x tap<br/>to start<br/>tracking</align>");
-	elm_table_pack(table_watch,ad->label_tracking,0,1,1,1);
-	evas_object_show(ad->label_tracking);
-	tracking_updater(ad, is_tracking);
-
-	/* Gesture */
-	Evas_Object *gest_track = elm_gesture_layer_add(table_watch);
-	elm_gesture_layer_attach(gest_track,table_watch);
-
-	//elm_gesture_layer_cb_set(gest_track, ELM_GESTURE_N_TAPS, ELM_GESTURE_STATE_START, tracking_button_onetap_start, ad);
-	elm_gesture_layer_cb_set(gest_track, ELM_GESTURE_N_DOUBLE_TAPS, ELM_GESTURE_STATE_END, tracking_button_clicked, ad);
+	if (edj_path == NULL || !elm_layout_file_set(layout, edj_path, group))
+		dlog_print(DLOG_ERROR, LOG_TAG, "failed to load group %s from %s", group, edj_path);
 
+	evas_object_size_hint_weight_set(layout,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
+	evas_object_size_hint_align_set(layout,EVAS_HINT_FILL, EVAS_HINT_FILL);
+	elm_table_pack(ad->screens, layout, 0, 0, 1, 1);
 
-	watch_time_h watch_time = NULL;
-	int ret = watch_time_get_current_time(&watch_time);
-	if (ret != APP_ERROR_NONE)
-		dlog_print(DLOG_ERROR, LOG_TAG, "failed to get current time. err = %d", ret);
+	return layout;
+}
 
-	update_watch(ad, watch_time, 0);
-	watch_time_delete(watch_time);
+static Evas_Object *
+create_watch_screen(appdata_s *ad)
+{
+	dlog_print(DLOG_INFO, LOG_TAG, "Started Watch Face GUI");
 
-	elm_naviframe_item_push(ad->nf, NULL,NULL, NULL,watch_bg, NULL);
+	Evas_Object *layout = create_screen_layout(ad, GROUP_WATCH);
 
-	dlog_print(DLOG_INFO, LOG_TAG, "Finished Watch Face GUI");
+	ad->watch_clock = clock_digits_add(layout, DIGIT_PALETTE_NORMAL);
+	elm_object_part_content_set(layout, PART_CLOCK, clock_digits_object_get(ad->watch_clock));
+	elm_object_part_content_set(layout, PART_SPARKLINE, sparkline_add(layout));
 
+	elm_object_signal_callback_add(layout, SIGNAL_ACTION_START_TRACKING, "", tracking_double_tapped, ad);
+
+	dlog_print(DLOG_INFO, LOG_TAG, "Finished Watch Face GUI");
 
+	return layout;
 }
 
-static void
-alarm_gui(appdata_s *ad)
+static Evas_Object *
+create_alarm_screen(appdata_s *ad)
 {
 	dlog_print(DLOG_INFO, LOG_TAG, "Alarm GUI started");
 
-	Evas_Object *alarm_bg = elm_bg_add(ad->nf);
-	elm_bg_color_set(alarm_bg,240,240,240);
-	evas_object_show(alarm_bg);
-
-
-	Evas_Object *table_alarm = elm_table_add(ad->nf);
-	evas_object_size_hint_weight_set(table_alarm,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	evas_object_size_hint_align_set(table_alarm,EVAS_HINT_FILL, EVAS_HINT_FILL);
-	evas_object_show(table_alarm);
-
-	elm_object_content_set(alarm_bg,table_alarm);
-
-	/* Dismiss Background */
-	ad->bg_dis = elm_bg_add(table_alarm);
-	elm_bg_color_set(ad->bg_dis,186,18,0);
-	evas_object_size_hint_min_set(ad->bg_dis, g_width, g_height*.2);
-	evas_object_size_hint_max_set(ad->bg_dis, g_width, g_height*.2);
-	evas_object_size_hint_weight_set(ad->bg_dis,0,0);
-	evas_object_size_hint_align_set(ad->bg_dis,0.5, 0);
-	evas_object_show(ad->bg_dis);
-	elm_table_pack(table_alarm,ad->bg_dis,0,0,1,1);
-
-	/* Label Dismiss */
-	Evas_Object *label_dis = elm_label_add(table_alarm);
-	elm_object_content_set(ad->bg_dis,label_dis);
-	evas_object_size_hint_min_set(label_dis, g_width, g_height*.2);
-	evas_object_size_hint_max_set(label_dis, g_width, g_height*.2);
-	evas_object_size_hint_align_set(label_dis,EVAS_HINT_FILL,EVAS_HINT_FILL);
-	evas_object_size_hint_weight_set(label_dis,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	elm_object_text_set(label_dis,"<align=center valign=center> <br/>Dismiss <br/> </align> ");
-	elm_table_pack(table_alarm,ad->bg_dis,0,0,1,1);
-	evas_object_show(label_dis);
-
-	/* Label Time */
-	ad->label_alarm_time = elm_label_add(table_alarm);
-	evas_object_color_set(ad->label_alarm_time,30,30,30,255);
-	elm_object_text_set(ad->label_alarm_time,"<align=center valign=center> TIME </align> ");
-	evas_object_size_hint_align_set(ad->label_alarm_time,EVAS_HINT_FILL,EVAS_HINT_FILL);
-	evas_object_size_hint_weight_set(ad->label_alarm_time,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	elm_table_pack(table_alarm,ad->label_alarm_time,0,1,1,1);
-	evas_object_show(ad->label_alarm_time);
-
-	/* Background Snooze */
-	ad->bg_snz = elm_bg_add(table_alarm);
-	elm_bg_color_set(ad->bg_snz,145,174,54);
-	evas_object_size_hint_min_set(ad->bg_snz, g_width, g_height*.2);
-	evas_object_size_hint_max_set(ad->bg_snz, g_width, g_height*.2);
-	evas_object_size_hint_weight_set(ad->bg_snz,EVAS_HINT_EXPAND,EVAS_HINT_EXPAND);
-	evas_object_size_hint_align_set(ad->bg_snz,0.5,0.9);
-	evas_object_show(ad->bg_snz);
-	elm_table_pack(table_alarm,ad->bg_snz,0,2,1,1);
-
-	/* Label Snooze */
-	Evas_Object *label_snz = elm_label_add(table_alarm);
-	elm_object_content_set(ad->bg_snz,label_snz);
-	evas_object_size_hint_min_set(label_snz, g_width, g_height*.2);
-	evas_object_size_hint_max_set(label_snz, g_width, g_height*.2);
-	evas_object_size_hint_align_set(label_snz,0.5,0.5);
-	evas_object_size_hint_weight_set(label_snz,0.5,1.0);
-	evas_object_size_hint_padding_set(label_snz,0,0,60,0);
-	elm_object_text_set(label_snz,"<align=center valign=center> <br/> Snooze <br/> </align> ");
-	elm_table_pack(table_alarm,label_snz,0,2,1,1);
-	evas_object_show(label_snz);
-
-	Evas_Object *gest_alarm = elm_gesture_layer_add(table_alarm);
-	elm_gesture_layer_attach(gest_alarm,table_alarm);
-	elm_gesture_layer_cb_set(gest_alarm, ELM_GESTURE_N_TAPS, ELM_GESTURE_STATE_END, alarm_touch_event,ad);
-
-
-	elm_naviframe_item_push(ad->nf,NULL,NULL, NULL, alarm_bg, NULL);
+	Evas_Object *layout = create_screen_layout(ad, GROUP_ALARM);
+
+	ad->alarm_clock = clock_digits_add(layout, DIGIT_PALETTE_ALARM);
+	elm_object_part_content_set(layout, PART_CLOCK, clock_digits_object_get(ad->alarm_clock));
+
+	elm_object_signal_callback_add(layout, SIGNAL_ACTION_DISMISS, "", dis_button_clicked, ad);
+	elm_object_signal_callback_add(layout, SIGNAL_ACTION_SNOOZE, "", snz_button_clicked, ad);
 
 	dlog_print(DLOG_INFO, LOG_TAG, "Alarm GUI Finished");
+
+	return layout;
+}
+
+/*
+ * @brief Makes one of the retained screens visible, nothing is created or destroyed here
+ * @param[ad] The application data
+ * @param[alarm] true for the alarm screen, false for the watch face
+ */
+static void
+switch_screen(appdata_s *ad, bool alarm)
+{
+	double start = ecore_time_get();
+
+	is_alarm_shown = alarm;
+	if (alarm) {
+		evas_object_hide(ad->watch_screen);
+		evas_object_show(ad->alarm_screen);
+	} else {
+		tracking_updater(ad, is_tracking);
+		evas_object_hide(ad->alarm_screen);
+		evas_object_show(ad->watch_screen);
+	}
+	update_watch_now(ad);
+
+	double ms = (ecore_time_get() - start) * 1000.0;
+	transitions++;
+	transitions_total_ms += ms;
+	dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Switched to %s screen in %.2f ms (avg %.2f ms over %d switches)",
+			alarm ? "alarm" : "watch", ms, transitions_total_ms / transitions, transitions);
+}
+
+static void
+show_watch_screen(appdata_s *ad)
+{
+	switch_screen(ad, false);
+}
+
+static void
+show_alarm_screen(appdata_s *ad)
+{
+	switch_screen(ad, true);
+}
+
+/*
+ * @brief Handles a command from the service, received over the message port or with a launch request
+ * @param[action] Command string, e.g. "alarm_started"
+ * @param[data] The application data
+ */
+static void handle_service_action(const char *action, void *data)
+{
+	if (strcmp(action, "alarm_started") == 0) {
+		show_alarm_screen(data);
+	} else if (strcmp(action, "alarm_finished") == 0) {
+		show_watch_screen(data);
+	} else {
+		dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Unsupported action! Doing nothing...");
+	}
+}
+
+/*
+ * @brief Applies a state transition the service published in the shared state record
+ * @param[state] Snapshot of the record
+ * @param[data] The application data
+ */
+static void handle_shared_state(const shared_state_s *state, void *data)
+{
+	if (start_pending) {
+		if (state->tracking) {
+			pending_start_finish(data, true);
+		} else if (state->start_answers != pending_start_answers && state->start_result == SHARED_START_REJECTED) {
+			pending_start_finish(data, false);
+			return;
+		} else {
+			/* Something else changed, keep showing the optimistic state until the service answers or we time out */
+			return;
+		}
+	}
+
+	paused_till = state->tracking ? state->paused_till : 0;
+	if (state->tracking != is_tracking || state->tracking)
+		tracking_updater(data, state->tracking);
+	sparkline_update(state);
 }
 
 /*
@@ -529,10 +511,33 @@ static bool app_create(int width, int height, void *data)
 		dlog_print(DLOG_ERROR, LOG_TAG, "watch_app_add_event_handler () is failed");
 
 	appdata_s *ad = data;
-	create_base_gui(ad, width, height);
-	watchface_gui(ad);
+	shared_state_s state;
+
+	/* Take the service state before the first frame instead of waiting for it to tell us */
+	if (state_reader_init(handle_shared_state, ad) && state_reader_read(&state)) {
+		is_tracking = state.tracking;
+		paused_till = state.tracking ? state.paused_till : 0;
+		is_alarm_shown = state.alarm_active;
+		dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Initial state tracking %d, paused till %lld, alarm %d",
+				state.tracking, (long long)state.paused_till, state.alarm_active);
+	}
 
-//	alarm_gui(ad);
+	double build_start = ecore_time_get();
+	create_base_gui(ad, width, height);
+	render_stats_init(ad->win);
+	digit_atlas_prepare();
+	ad->watch_screen = create_watch_screen(ad);
+	ad->alarm_screen = create_alarm_screen(ad);
+	dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Screens built in %.1f ms", (ecore_time_get() - build_start) * 1000.0);
+	render_stats_log_objects(ad->win);
+	if (is_alarm_shown)
+		show_alarm_screen(ad);
+	else
+		show_watch_screen(ad);
+	if (is_tracking)
+		sparkline_update(&state);
+
+	service_channel_init(handle_service_action, ad);
 
 	evas_object_show(ad->win);
 
@@ -554,23 +559,17 @@ static void app_control(app_control_h app_control, void *data){
 	}
 
 	char *action_value = NULL;
-	if (app_control_get_extra_data(app_control, "app_action", &action_value) == APP_CONTROL_ERROR_NONE) {
+	if (app_control_get_extra_data(app_control, KEY_ACTION, &action_value) == APP_CONTROL_ERROR_NONE && action_value != NULL) {
 		dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: App control action: %s", action_value);
 
-		// Add start?
-		if (action_value != NULL && strcmp(action_value, "alarm_started") == 0) {
-			alarm_gui(data);
-		} else if (action_value != NULL && strcmp(action_value, "alarm_finished") == 0) {
-			watchface_gui(data);
-			//			tracking_updater(data, true);
-		} else if (action_value != NULL && strcmp(action_value, "tracking_on") == 0) {
-			tracking_updater(data, true);
-		} else if (action_value != NULL && strcmp(action_value, "tracking_off") == 0) {
-			tracking_updater(data, false);
-		} else{
-			dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Unsupported action! Doing nothing...");
-			free(action_value);
+		char *sent_at = NULL;
+		if (app_control_get_extra_data(app_control, KEY_SENT_AT, &sent_at) == APP_CONTROL_ERROR_NONE) {
+			service_channel_note_latency("launch", sent_at);
+			free(sent_at);
 		}
+
+		handle_service_action(action_value, data);
+		free(action_value);
 	} else {
 		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Failed to get app control attribute");
 	}
@@ -606,18 +605,9 @@ static void app_resume(void *data)
 static void app_terminate(void *data)
 {
 	send_service_command("terminate");
-}
-
-/*
- * @brief Called at each second. This callback is not called while the app is paused or the device is in ambient mode.
- * @param[in] watch_time The watch time handle. watch_time will not be available after returning this callback. It will be freed by the framework.
- * @param[in] data The user data to be passed to the callback functions
- */
-static void app_time_tick(watch_time_h watch_time, void *data)
-{
-	/* Called at each second while your app is visible. Update watch UI. */
-//	appdata_s *ad = data;
-//	update_watch(ad, watch_time, 0);
+	service_channel_shutdown();
+	state_reader_shutdown();
+	render_stats_shutdown();
 }
 
 /*
@@ -629,7 +619,18 @@ static void app_ambient_tick(watch_time_h watch_time, void *data)
 {
 	/* Called at each minute while the device is in ambient mode. Update watch UI. */
 	appdata_s *ad = data;
+	render_stats_tick_begin(is_alarm_shown ? "alarm" : is_tracking ? "tracking" : "ambient");
 	update_watch(ad, watch_time, 1);
+	if (is_tracking && paused_till != 0) {
+		pause_label_update(ad);
+	}
+	if (is_tracking && !is_alarm_shown) {
+		/* Epochs are published without waking us, pick up the new ones with the minute */
+		shared_state_s state;
+		if (state_reader_read(&state))
+			sparkline_update(&state);
+	}
+	render_stats_tick_end();
 }
 
 /*
@@ -640,6 +641,8 @@ static void app_ambient_changed(bool ambient_mode, void* data)
 	/*
 	 * Take necessary actions when application goes to/from ambient state
 	 */
+	appdata_s *ad = data;
+	clock_digits_palette_set(ad->watch_clock, ambient_mode ? DIGIT_PALETTE_AMBIENT : DIGIT_PALETTE_NORMAL);
 }
 
 static void
@@ -675,7 +678,6 @@ int main(int argc, char *argv[])
 	event_callback.pause = app_pause;
 	event_callback.resume = app_resume;
 	event_callback.app_control = app_control;
-//	event_callback.time_tick = app_time_tick;
 	event_callback.ambient_tick = app_ambient_tick;
 	event_callback.ambient_changed = app_ambient_changed;
 
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <Elementary.h>
+#include "sleepasandroidgearfitwatchface.h"
+#include "render_stats.h"
+
+/* Aggregates are logged once per this many ticks, an hour of ambient ticks */
+#define LOG_EVERY_TICKS 60
+#define MAX_STATES 4
+
+/* Cost of the ticks seen in one UI state (ambient, tracking, alarm) */
+struct state_stats {
+	const char *name;
+	long ticks;
+	double update_ms;
+	double render_ms;
+	long pixels;
+};
+
+static struct stats_info {
+	Evas *evas;
+	double created_at;
+	bool first_frame_done;
+	/* Tick whose render is still to come, NULL when renders are not caused by a tick */
+	struct state_stats *pending;
+	/* User action waiting for its first frame on screen, NULL when none */
+	const char *feedback;
+	double feedback_started_at;
+	double tick_started_at;
+	double render_started_at;
+	long ticks_since_log;
+	struct state_stats states[MAX_STATES];
+} s_info = {
+	.evas = NULL,
+	.pending = NULL,
+	.feedback = NULL,
+};
+
+static struct state_stats *_state_get(const char *name)
+{
+	int i;
+
+	for (i = 0; i < MAX_STATES; i++) {
+		if (s_info.states[i].name == NULL)
+			s_info.states[i].name = name;
+		if (strcmp(s_info.states[i].name, name) == 0)
+			return &s_info.states[i];
+	}
+	return &s_info.states[MAX_STATES - 1];
+}
+
+static void _render_pre_cb(void *data, Evas *e, void *event_info)
+{
+	s_info.render_started_at = ecore_time_get();
+}
+
+static void _render_post_cb(void *data, Evas *e, void *event_info)
+{
+	Evas_Event_Render_Post *post = event_info;
+	Eina_Rectangle *rect;
+	Eina_List *l;
+	long pixels = 0;
+	double now = ecore_time_get();
+
+	if (post) {
+		EINA_LIST_FOREACH(post->updated_area, l, rect)
+			pixels += (long)rect->w * rect->h;
+	}
+
+	if (!s_info.first_frame_done) {
+		s_info.first_frame_done = true;
+		dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: First frame %.1f ms after create, %ld px",
+				(now - s_info.created_at) * 1000.0, pixels);
+	}
+
+	if (s_info.feedback) {
+		dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: %s feedback on screen after %.1f ms",
+				s_info.feedback, (now - s_info.feedback_started_at) * 1000.0);
+		s_info.feedback = NULL;
+	}
+
+	if (s_info.pending == NULL)
+		return;
+
+	s_info.pending->render_ms += (now - s_info.render_started_at) * 1000.0;
+	s_info.pending->pixels += pixels;
+	s_info.pending = NULL;
+}
+
+/*
+ * @brief Starts collecting render statistics for the canvas of the window
+ * @param[win] The application window
+ */
+void render_stats_init(Evas_Object *win)
+{
+	memset(s_info.states, 0, sizeof(s_info.states));
+	s_info.created_at = ecore_time_get();
+	s_info.first_frame_done = false;
+	s_info.pending = NULL;
+	s_info.ticks_since_log = 0;
+
+	s_info.evas = evas_object_evas_get(win);
+	evas_event_callback_add(s_info.evas, EVAS_CALLBACK_RENDER_PRE, _render_pre_cb, NULL);
+	evas_event_callback_add(s_info.evas, EVAS_CALLBACK_RENDER_POST, _render_post_cb, NULL);
+}
+
+void render_stats_shutdown(void)
+{
+	if (s_info.evas == NULL)
+		return;
+
+	render_stats_log();
+	evas_event_callback_del_full(s_info.evas, EVAS_CALLBACK_RENDER_PRE, _render_pre_cb, NULL);
+	evas_event_callback_del_full(s_info.evas, EVAS_CALLBACK_RENDER_POST, _render_post_cb, NULL);
+	s_info.evas = NULL;
+}
+
+/*
+ * @brief Marks the start of a tick, the following render is accounted to it
+ * @param[state] UI state the tick runs in, a string literal
+ */
+void render_stats_tick_begin(const char *state)
+{
+	s_info.pending = _state_get(state);
+	s_info.pending->ticks++;
+	s_info.tick_started_at = ecore_time_get();
+}
+
+/*
+ * @brief Logs how long it takes from now until the next frame reaches the screen
+ * @param[what] Name of the user action, a string literal
+ */
+void render_stats_feedback_begin(const char *what)
+{
+	s_info.feedback = what;
+	s_info.feedback_started_at = ecore_time_get();
+}
+
+void render_stats_tick_end(void)
+{
+	if (s_info.pending == NULL)
+		return;
+
+	s_info.pending->update_ms += (ecore_time_get() - s_info.tick_started_at) * 1000.0;
+
+	if (++s_info.ticks_since_log >= LOG_EVERY_TICKS) {
+		s_info.ticks_since_log = 0;
+		render_stats_log();
+	}
+}
+
+void render_stats_log(void)
+{
+	int i;
+
+	for (i = 0; i < MAX_STATES && s_info.states[i].name; i++) {
+		struct state_stats *st = &s_info.states[i];
+		if (st->ticks == 0)
+			continue;
+		dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: %s ticks %ld, avg update %.2f ms, avg render %.2f ms, avg %ld px redrawn",
+				st->name, st->ticks, st->update_ms / st->ticks, st->render_ms / st->ticks, st->pixels / st->ticks);
+	}
+}
+
+static int _objects_count(const Evas_Object *obj)
+{
+	Eina_List *members = evas_object_smart_members_get(obj);
+	Evas_Object *member;
+	int count = 1;
+
+	EINA_LIST_FREE(members, member)
+		count += _objects_count(member);
+
+	return count;
+}
+
+/* Resident set of the process in kB, -1 when it cannot be read */
+static long _rss_kb(void)
+{
+	char line[128];
+	long kb = -1;
+	FILE *f = fopen("/proc/self/status", "r");
+
+	if (!f)
+		return -1;
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "VmRSS: %ld kB", &kb) == 1)
+			break;
+	}
+	fclose(f);
+	return kb;
+}
+
+/*
+ * @brief Logs how many Evas objects the tree under root consists of and the resident memory of the process
+ * @param[root] Usually the window
+ */
+void render_stats_log_objects(Evas_Object *root)
+{
+	dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: %d Evas objects in the tree, RSS %ld kB", _objects_count(root), _rss_kb());
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bundle.h>
+#include <message_port.h>
+#include <Elementary.h>
+#include "sleepasandroidgearfitwatchface.h"
+#include "service_channel.h"
+
+static struct channel_info {
+	int local_port_id;
+	service_action_cb action_cb;
+	void *action_data;
+} s_info = {
+	.local_port_id = -1,
+	.action_cb = NULL,
+	.action_data = NULL,
+};
+
+/* Command latency per delivery path, so the port can be compared with launch requests */
+static struct latency_stats {
+	long count;
+	double total_ms;
+	double max_ms;
+} port_latency, launch_latency;
+
+static void _sent_at_fill(char *buf, size_t len)
+{
+	snprintf(buf, len, "%.0f", ecore_time_unix_get() * 1000.0);
+}
+
+/*
+ * @brief Logs how long a command took from the service to us
+ * @param[via] "port" or "launch"
+ * @param[sent_at] Send time in ms as written by the sender, may be NULL
+ */
+void service_channel_note_latency(const char *via, const char *sent_at)
+{
+	if (sent_at == NULL)
+		return;
+
+	struct latency_stats *stats = strcmp(via, "port") == 0 ? &port_latency : &launch_latency;
+	double ms = ecore_time_unix_get() * 1000.0 - atof(sent_at);
+	stats->count++;
+	stats->total_ms += ms;
+	if (ms > stats->max_ms)
+		stats->max_ms = ms;
+
+	dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Command via %s took %.0f ms (avg %.1f ms, max %.0f ms, %ld commands)",
+			via, ms, stats->total_ms / stats->count, stats->max_ms, stats->count);
+}
+
+static void _port_message_cb(int local_port_id, const char *remote_app_id, const char *remote_port,
+		bool trusted_remote_port, bundle *message, void *user_data)
+{
+	char *action = NULL;
+	char *sent_at = NULL;
+
+	if (bundle_get_str(message, KEY_ACTION, &action) != 0 || action == NULL) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Port message without action from %s", remote_app_id);
+		return;
+	}
+
+	if (bundle_get_str(message, KEY_SENT_AT, &sent_at) == 0)
+		service_channel_note_latency("port", sent_at);
+
+	s_info.action_cb(action, s_info.action_data);
+}
+
+/*
+ * @brief Opens our end of the persistent channel to the service
+ * @param[action_received] Called for every command coming over the channel
+ * @param[data] User data passed to action_received
+ */
+void service_channel_init(service_action_cb action_received, void *data)
+{
+	s_info.action_cb = action_received;
+	s_info.action_data = data;
+
+	s_info.local_port_id = message_port_register_local_port(WATCHFACE_PORT, _port_message_cb, NULL);
+	if (s_info.local_port_id < 0)
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Failed to register port (%d), using launch requests only", s_info.local_port_id);
+}
+
+void service_channel_shutdown(void)
+{
+	if (s_info.local_port_id < 0)
+		return;
+
+	message_port_unregister_local_port(s_info.local_port_id);
+	s_info.local_port_id = -1;
+}
+
+static bool _port_message_send(const char *command)
+{
+	bool exists = false;
+	char sent_at[32];
+	bundle *message = NULL;
+	int ret;
+
+	if (message_port_check_remote_port(SERVICE_APP_ID, SERVICE_PORT, &exists) != MESSAGE_PORT_ERROR_NONE || !exists)
+		return false;
+
+	_sent_at_fill(sent_at, sizeof(sent_at));
+
+	message = bundle_create();
+	bundle_add_str(message, KEY_ACTION, command);
+	bundle_add_str(message, KEY_SENT_AT, sent_at);
+	ret = message_port_send_message(SERVICE_APP_ID, SERVICE_PORT, message);
+	bundle_free(message);
+
+	if (ret != MESSAGE_PORT_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Port message failed (%d): %s", ret, command);
+		return false;
+	}
+
+	dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: Port message sent: %s", command);
+	return true;
+}
+
+static void _launch_request_send(const char *command)
+{
+	app_control_h app_control;
+	char sent_at[32];
+
+	_sent_at_fill(sent_at, sizeof(sent_at));
+
+	if (app_control_create(&app_control) == APP_CONTROL_ERROR_NONE) {
+		int res1 = 0, res2 = 0, res3 = 0;
+		if (((res1 = app_control_set_app_id(app_control, SERVICE_APP_ID)) == APP_CONTROL_ERROR_NONE)
+				&& ((res2 = app_control_add_extra_data(app_control, KEY_ACTION, command)) == APP_CONTROL_ERROR_NONE)
+				&& (app_control_add_extra_data(app_control, KEY_SENT_AT, sent_at) == APP_CONTROL_ERROR_NONE)
+				&& ((res3 = app_control_send_launch_request(app_control, NULL, NULL)) == APP_CONTROL_ERROR_NONE)) {
+			dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: App command request sent: %s", command);
+		} else {
+			dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: App command request sending failed! Err: %d %d %d", res1, res2, res3);
+		}
+		if (app_control_destroy(app_control) == APP_CONTROL_ERROR_NONE) {
+			dlog_print(DLOG_INFO, LOG_TAG, "WatchFace: App control destroyed.");
+		}
+	} else {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: App control creation failed!");
+	}
+}
+
+/*
+ * @brief Sends a command to the service, over the port when the service is running, otherwise by launching it
+ * @param[command] Command string, e.g. "start_tracking"
+ */
+void service_channel_send(const char *command)
+{
+	if (_port_message_send(command))
+		return;
+
+	_launch_request_send(command);
+}
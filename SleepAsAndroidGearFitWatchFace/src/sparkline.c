@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <math.h>
+#include <Elementary.h>
+#include "sleepasandroidgearfitwatchface.h"
+#include "sparkline.h"
+
+/* One column per epoch, the pixel buffer is a ring of columns as wide as the shared ring */
+#define SPARK_W SHARED_STATE_RING
+#define SPARK_H 24
+/* max_sum at which a column is full height, the scale is square-root so calm sleep still shows */
+#define SPARK_FULL_SCALE 10.0f
+
+#define COLOR_MAX 0xff2e5b7a
+#define COLOR_AVG 0xff7fc4f0
+#define COLOR_NONE 0x00000000
+
+static struct sparkline_info {
+	Evas_Object *image;
+	/* Epochs of the session already drawn into the buffer */
+	uint32_t drawn;
+} s_info = {
+	.image = NULL,
+	.drawn = 0,
+};
+
+static int _level(float value)
+{
+	float level;
+
+	if (value <= 0.0f)
+		return 0;
+
+	level = sqrtf(value / SPARK_FULL_SCALE);
+	if (level > 1.0f)
+		level = 1.0f;
+	return (int)(level * SPARK_H + 0.5f);
+}
+
+static void _column_draw(uint32_t *pixels, int stride, int col, const shared_epoch_s *epoch)
+{
+	int max_h = _level(epoch ? epoch->max_sum : 0);
+	int avg_h = _level(epoch ? epoch->avg_sum : 0);
+	int y;
+
+	for (y = 0; y < SPARK_H; y++) {
+		int from_bottom = SPARK_H - y;
+		uint32_t color = COLOR_NONE;
+		if (from_bottom <= avg_h)
+			color = COLOR_AVG;
+		else if (from_bottom <= max_h)
+			color = COLOR_MAX;
+		pixels[y * stride + col] = color;
+	}
+}
+
+/* The newest column is drawn at (count - 1) % SPARK_W. Shifting the fill origin by the ring position makes
+ * the tiled image start with the oldest column, so nothing is ever scrolled in memory */
+static void _fill_update(void)
+{
+	Evas_Coord w, h;
+
+	evas_object_geometry_get(s_info.image, NULL, NULL, &w, &h);
+	if (w <= 0 || h <= 0)
+		return;
+
+	evas_object_image_fill_set(s_info.image, -(Evas_Coord)((s_info.drawn % SPARK_W) * w / SPARK_W), 0, w, h);
+}
+
+static void _resize_cb(void *data, Evas *e, Evas_Object *obj, void *event_info)
+{
+	_fill_update();
+}
+
+/*
+ * @brief Creates the sparkline image, empty until the first update
+ * @param[parent] Parent object, the image has to be packed or swallowed by the caller
+ */
+Evas_Object *sparkline_add(Evas_Object *parent)
+{
+	uint32_t *pixels;
+	int stride, col;
+
+	s_info.image = evas_object_image_add(evas_object_evas_get(parent));
+	evas_object_image_alpha_set(s_info.image, EINA_TRUE);
+	evas_object_image_size_set(s_info.image, SPARK_W, SPARK_H);
+	evas_object_image_smooth_scale_set(s_info.image, EINA_FALSE);
+	evas_object_event_callback_add(s_info.image, EVAS_CALLBACK_RESIZE, _resize_cb, NULL);
+
+	pixels = evas_object_image_data_get(s_info.image, EINA_TRUE);
+	stride = evas_object_image_stride_get(s_info.image) / 4;
+	for (col = 0; col < SPARK_W; col++)
+		_column_draw(pixels, stride, col, NULL);
+	evas_object_image_data_set(s_info.image, pixels);
+	evas_object_image_data_update_add(s_info.image, 0, 0, SPARK_W, SPARK_H);
+
+	s_info.drawn = 0;
+	return s_info.image;
+}
+
+/*
+ * @brief Draws the epochs the service added to the ring since the last update, one column each
+ * @param[state] Snapshot of the shared state record
+ */
+void sparkline_update(const shared_state_s *state)
+{
+	uint32_t *pixels;
+	uint32_t from, i;
+	int stride;
+
+	if (s_info.image == NULL || state->epoch_count == s_info.drawn)
+		return;
+
+	pixels = evas_object_image_data_get(s_info.image, EINA_TRUE);
+	stride = evas_object_image_stride_get(s_info.image) / 4;
+
+	if (state->epoch_count < s_info.drawn) {
+		/* A new session started, start from an empty line */
+		for (i = 0; i < SPARK_W; i++)
+			_column_draw(pixels, stride, i, NULL);
+		evas_object_image_data_update_add(s_info.image, 0, 0, SPARK_W, SPARK_H);
+		s_info.drawn = 0;
+	}
+
+	/* Anything older than the ring is gone anyway */
+	from = s_info.drawn;
+	if (state->epoch_count - from > SHARED_STATE_RING)
+		from = state->epoch_count - SHARED_STATE_RING;
+
+	for (i = from; i < state->epoch_count; i++) {
+		_column_draw(pixels, stride, i % SPARK_W, &state->ring[i % SHARED_STATE_RING]);
+		evas_object_image_data_update_add(s_info.image, i % SPARK_W, 0, 1, SPARK_H);
+	}
+	evas_object_image_data_set(s_info.image, pixels);
+
+	s_info.drawn = state->epoch_count;
+	_fill_update();
+}
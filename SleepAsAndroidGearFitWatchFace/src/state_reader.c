@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Ecore_File.h>
+#include <Elementary.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "sleepasandroidgearfitwatchface.h"
+#include "state_reader.h"
+
+/* A writer holds seq odd only for a few stores, a handful of retries is plenty */
+#define READ_ATTEMPTS 16
+
+static struct reader_info {
+	const shared_state_s *page;
+	Ecore_File_Monitor *monitor;
+	char path[PATH_MAX];
+	state_changed_cb state_changed;
+	void *data;
+} s_info = {
+	.page = NULL,
+	.monitor = NULL,
+	.state_changed = NULL,
+	.data = NULL,
+};
+
+static bool _page_map(void)
+{
+	struct stat st;
+	void *page;
+	int fd;
+
+	if (s_info.page)
+		return true;
+
+	fd = open(s_info.path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	/* The service sizes the file right after creating it, we may see it before that */
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(shared_state_s)) {
+		close(fd);
+		return false;
+	}
+
+	page = mmap(NULL, sizeof(shared_state_s), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (page == MAP_FAILED) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Failed to map %s", s_info.path);
+		return false;
+	}
+
+	s_info.page = page;
+	return true;
+}
+
+/*
+ * @brief Copies a consistent snapshot of the state record
+ * @param[state] Filled with the record
+ * @return false when the service has not published a usable record yet
+ */
+bool state_reader_read(shared_state_s *state)
+{
+	int attempt;
+
+	if (!_page_map())
+		return false;
+
+	for (attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+		uint32_t seq = s_info.page->seq;
+		if (seq & 1)
+			continue;
+
+		__sync_synchronize();
+		memcpy(state, (const void *)s_info.page, sizeof(shared_state_s));
+		__sync_synchronize();
+
+		if (s_info.page->seq == seq)
+			return state->version == SHARED_STATE_VERSION;
+	}
+
+	dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: State record kept changing, giving up");
+	return false;
+}
+
+static void _monitor_cb(void *data, Ecore_File_Monitor *em, Ecore_File_Event event, const char *path)
+{
+	shared_state_s state;
+
+	if (event != ECORE_FILE_EVENT_CREATED_FILE && event != ECORE_FILE_EVENT_MODIFIED)
+		return;
+	if (strcmp(path, s_info.path) != 0)
+		return;
+
+	if (state_reader_read(&state))
+		s_info.state_changed(&state, s_info.data);
+}
+
+/*
+ * @brief Maps the state record published by the service and watches it for changes
+ * @param[state_changed] Called on every state transition the service publishes, not for the initial state
+ * @param[data] User data passed to state_changed
+ * @return true when the record could be mapped right away
+ */
+bool state_reader_init(state_changed_cb state_changed, void *data)
+{
+	char *data_path;
+
+	s_info.state_changed = state_changed;
+	s_info.data = data;
+
+	data_path = app_get_data_path();
+	if (data_path == NULL) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: No data path, state record not available");
+		return false;
+	}
+	snprintf(s_info.path, sizeof(s_info.path), "%s%s", data_path, SHARED_STATE_FILE);
+
+	/* Watch the directory, the record does not exist until the service ran for the first time */
+	ecore_file_init();
+	s_info.monitor = ecore_file_monitor_add(data_path, _monitor_cb, NULL);
+	if (s_info.monitor == NULL) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "WatchFace: Failed to watch %s", data_path);
+		ecore_file_shutdown();
+	}
+	free(data_path);
+
+	return _page_map();
+}
+
+void state_reader_shutdown(void)
+{
+	if (s_info.monitor) {
+		ecore_file_monitor_del(s_info.monitor);
+		s_info.monitor = NULL;
+		ecore_file_shutdown();
+	}
+	if (s_info.page) {
+		munmap((void *)s_info.page, sizeof(shared_state_s));
+		s_info.page = NULL;
+	}
+}
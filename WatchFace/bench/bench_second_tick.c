@@ -0,0 +1,161 @@
+/*
+ * Host benchmark of the second hand on the Ecore_Evas buffer engine, CPU per second of wall time.
+ * The watch face is built from its own sources, only the framework is replaced (stubs/).
+ *
+ * Usage: bench_second_tick [layout|tick|all] [seconds]
+ *   layout  The layout's timer moves the hand, C resyncs twice a minute. This is what the app does.
+ *   tick    A C tick on every wall second reads the time and sends the second into the layout,
+ *           the way app_time_tick did before. The layout timer is stopped after each step so only
+ *           the C tick moves the hand. The strings still come from the 00..59 table, so the
+ *           difference to layout mode is the per-second path alone.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <watch_app_efl.h>
+#include "fake_watch_app.h"
+
+/* The watch face, with its main() out of the way */
+#define main watchface_main
+#include "../src/main.c"
+#undef main
+
+#define DEFAULT_SECONDS 60
+/* Lets the first frames and image loads settle before measuring */
+#define WARMUP_SECONDS 2.0
+
+static struct bench_info {
+	long frames;
+	Ecore_Timer *tick_timer;
+} s_bench = {
+	.frames = 0,
+	.tick_timer = NULL,
+};
+
+static double _cpu_sec(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static void _render_post_cb(void *data, Evas *e, void *event_info)
+{
+	s_bench.frames++;
+}
+
+static Eina_Bool _quit_cb(void *data)
+{
+	ecore_main_loop_quit();
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool _tick_cb(void *data)
+{
+	watch_time_h watch_time;
+
+	if (watch_time_get_current_time(&watch_time) != APP_ERROR_NONE)
+		return ECORE_CALLBACK_RENEW;
+	_time_get(watch_time);
+	watch_time_delete(watch_time);
+
+	if (s_info.second == 60 - (int)MINUTE_PART_ANIMATION_TIME) {
+		view_set_minute(s_info.minute);
+		view_start_minute_update();
+	} else if (s_info.second == 0 && s_info.minute == 0) {
+		view_set_hour(s_info.hour);
+	}
+
+	view_set_second(s_info.second, 0);
+	view_stop_second();
+	return ECORE_CALLBACK_RENEW;
+}
+
+static Eina_Bool _first_tick_cb(void *data)
+{
+	_tick_cb(NULL);
+	s_bench.tick_timer = ecore_timer_add(1.0, _tick_cb, NULL);
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static void _tick_start(void)
+{
+	watch_time_h watch_time;
+	int millisecond = 0;
+
+	/* The framework's time tick lands on the wall second */
+	view_set_minute_sync_cb(NULL);
+	if (watch_time_get_current_time(&watch_time) == APP_ERROR_NONE) {
+		watch_time_get_millisecond(watch_time, &millisecond);
+		watch_time_delete(watch_time);
+	}
+	s_bench.tick_timer = ecore_timer_add((1000 - millisecond) / 1000.0, _first_tick_cb, NULL);
+}
+
+static void _tick_stop(void)
+{
+	if (s_bench.tick_timer) {
+		ecore_timer_del(s_bench.tick_timer);
+		s_bench.tick_timer = NULL;
+	}
+	view_set_minute_sync_cb(_minute_sync);
+	_curent_time_get();
+}
+
+static void _run(const char *mode, int seconds)
+{
+	double cpu, wall;
+	long frames;
+
+	if (strcmp(mode, "tick") == 0)
+		_tick_start();
+
+	ecore_timer_add(WARMUP_SECONDS, _quit_cb, NULL);
+	ecore_main_loop_begin();
+
+	cpu = _cpu_sec();
+	wall = ecore_time_get();
+	frames = s_bench.frames;
+	ecore_timer_add(seconds, _quit_cb, NULL);
+	ecore_main_loop_begin();
+	cpu = _cpu_sec() - cpu;
+	wall = ecore_time_get() - wall;
+	frames = s_bench.frames - frames;
+
+	printf("%-6s: %.3f ms CPU per second, %.2f frames per second (%.0f s at %dx%d)\n",
+			mode, cpu * 1000.0 / wall, frames / wall, wall, FAKE_SCREEN_W, FAKE_SCREEN_H);
+
+	if (strcmp(mode, "tick") == 0)
+		_tick_stop();
+}
+
+int main(int argc, char *argv[])
+{
+	const char *mode = argc > 1 ? argv[1] : "all";
+	int seconds = argc > 2 ? atoi(argv[2]) : DEFAULT_SECONDS;
+	Evas_Object *win = NULL;
+
+	if (seconds <= 0)
+		seconds = DEFAULT_SECONDS;
+
+	if (!fake_watch_app_init()) {
+		fprintf(stderr, "Failed to initialize Elementary on the buffer engine\n");
+		return 1;
+	}
+	if (!app_create(FAKE_SCREEN_W, FAKE_SCREEN_H, NULL) || watch_app_get_elm_win(&win) != APP_ERROR_NONE) {
+		fprintf(stderr, "app_create failed\n");
+		return 1;
+	}
+	evas_event_callback_add(evas_object_evas_get(win), EVAS_CALLBACK_RENDER_POST, _render_post_cb, NULL);
+
+	if (strcmp(mode, "all") == 0 || strcmp(mode, "layout") == 0)
+		_run("layout", seconds);
+	if (strcmp(mode, "all") == 0 || strcmp(mode, "tick") == 0)
+		_run("tick", seconds);
+
+	app_terminate(NULL);
+	fake_watch_app_shutdown();
+	return 0;
+}
@@ -0,0 +1,4 @@
+#if !defined(__BENCH_STUB_EFL_EXTENSION_H__)
+#define __BENCH_STUB_EFL_EXTENSION_H__
+
+#endif
@@ -0,0 +1,21 @@
+#if !defined(__BENCH_FAKE_WATCH_APP_H__)
+#define __BENCH_FAKE_WATCH_APP_H__
+
+#include <watch_app.h>
+
+/* Round Gear screen, the size the framework hands to app_create */
+#define FAKE_SCREEN_W 360
+#define FAKE_SCREEN_H 360
+
+/*
+ * @brief Starts Elementary on the buffer engine
+ * @return false when Elementary could not be initialized
+ */
+bool fake_watch_app_init(void);
+
+/*
+ * @brief Shuts Elementary down, call it after app_terminate
+ */
+void fake_watch_app_shutdown(void);
+
+#endif
@@ -0,0 +1,42 @@
+#if !defined(__BENCH_STUB_WATCH_APP_H__)
+#define __BENCH_STUB_WATCH_APP_H__
+
+/* Host stand-in for the watch application framework, the benchmark calls the lifecycle callbacks itself */
+#include <stdbool.h>
+#include <app.h>
+
+typedef struct _watch_time_s *watch_time_h;
+
+typedef bool (*watch_app_create_cb)(int width, int height, void *user_data);
+typedef void (*watch_app_control_cb)(app_control_h app_control, void *user_data);
+typedef void (*watch_app_pause_cb)(void *user_data);
+typedef void (*watch_app_resume_cb)(void *user_data);
+typedef void (*watch_app_terminate_cb)(void *user_data);
+typedef void (*watch_app_time_tick_cb)(watch_time_h watch_time, void *user_data);
+typedef void (*watch_app_ambient_tick_cb)(watch_time_h watch_time, void *user_data);
+typedef void (*watch_app_ambient_changed_cb)(bool ambient_mode, void *user_data);
+
+typedef struct {
+	watch_app_create_cb create;
+	watch_app_control_cb app_control;
+	watch_app_resume_cb resume;
+	watch_app_pause_cb pause;
+	watch_app_terminate_cb terminate;
+	watch_app_time_tick_cb time_tick;
+	watch_app_ambient_tick_cb ambient_tick;
+	watch_app_ambient_changed_cb ambient_changed;
+} watch_app_lifecycle_callback_s;
+
+int watch_app_main(int argc, char **argv, watch_app_lifecycle_callback_s *callback, void *user_data);
+void watch_app_exit(void);
+int watch_app_add_event_handler(app_event_handler_h *event_handler, app_event_type_e event_type, app_event_cb callback, void *user_data);
+
+int watch_time_get_current_time(watch_time_h *watch_time);
+int watch_time_delete(watch_time_h watch_time);
+int watch_time_get_hour(watch_time_h watch_time, int *hour);
+int watch_time_get_hour24(watch_time_h watch_time, int *hour24);
+int watch_time_get_minute(watch_time_h watch_time, int *minute);
+int watch_time_get_second(watch_time_h watch_time, int *second);
+int watch_time_get_millisecond(watch_time_h watch_time, int *millisecond);
+
+#endif
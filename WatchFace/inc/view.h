@@ -20,6 +20,8 @@
 #include <Elementary.h>
 #include <efl_extension.h>
 
+typedef void (*view_minute_sync_cb)(int second);
+
 void view_create_with_size(int width, int height);
 void view_create(void);
 Evas_Object *view_create_win(const char *pkg_name);
@@ -27,7 +29,9 @@ Evas_Object *view_create_layout_for_part(Evas_Object *parent, char *file_path, c
 void view_destroy(void);
 void view_set_hour(int hour);
 void view_set_minute(int minute);
-void view_set_second(int second);
+void view_set_second(int second, int millisecond);
+void view_stop_second(void);
+void view_set_minute_sync_cb(view_minute_sync_cb cb);
 void view_start_minute_update(void);
 void view_update_display_time(int hour, int minute);
 void view_set_ambient_mode(Eina_Bool ambient);
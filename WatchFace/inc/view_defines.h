@@ -26,9 +26,15 @@
 #define SIGNAL_MINUTE_CHANGE_ANIM_START "minute,change,anim,start"
 #define SIGNAL_SECOND_STATE_VISIBLE "second,state,visible"
 #define SIGNAL_SECOND_STATE_HIDDEN "second,state,hidden"
+#define SIGNAL_SECOND_STOP "second,stop"
 #define LAYOUT_GROUP_MAIN "layout_group_main"
 #define MSG_ID_MINUTE_PART_NEW_OUTSIDE 1
 #define MSG_ID_SECOND_PART 2
+#define MSG_ID_MINUTE_SYNC 3
 #define MINUTE_PART_ANIMATION_TIME 1.0
+/* Second at which the layout asks the application to roll the minute, 60 - MINUTE_PART_ANIMATION_TIME.
+ * It asks again at second 0. Each time the application compares the wall time with what is shown
+ * and puts the hand back on the wall second, which also undoes the drift of the layout's timer */
+#define MINUTE_SYNC_SECOND 59
 
 #endif
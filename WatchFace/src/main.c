@@ -24,14 +24,24 @@ struct main_info {
 	int hour;
 	int minute;
 	int second;
+	int millisecond;
+	/* What the layout shows, compared against the wall time on every sync */
+	int shown_hour;
+	int shown_minute;
 } s_info = {
 	.hour = 0,
 	.minute = 0,
 	.second = 0,
+	.millisecond = 0,
+	.shown_hour = -1,
+	.shown_minute = -1,
 };
 
 static void _time_get(watch_time_h watch_time);
 static void _curent_time_get(void);
+static void _second_resync(void);
+static void _minute_sync(int second);
+static void _show_time(int hour, int minute);
 
 /*
  * @brief The system language changed event callback function
@@ -158,6 +168,7 @@ static bool app_create(int width, int height, void* user_data)
 		dlog_print(DLOG_ERROR, LOG_TAG, "watch_app_add_event_handler () is failed");
 
 	view_create_with_size(width, height);
+	view_set_minute_sync_cb(_minute_sync);
 
 	_curent_time_get();
 
@@ -188,6 +199,7 @@ static void app_pause(void *user_data)
 	/*
 	 * Take necessary actions when application becomes invisible.
 	 */
+	view_stop_second();
 }
 
 /*
@@ -213,22 +225,37 @@ static void app_terminate(void *user_data)
 }
 
 /*
- * @brief Called at each second. This callback is not called while the app is paused or the device is in ambient mode.
- * @param[in] watch_time The watch time handle. watch_time will not be available after returning this callback. It will be freed by the framework.
- * @param[in] user_data The user data to be passed to the callback functions
+ * @brief Called by the layout, which moves the second hand itself, at MINUTE_SYNC_SECOND and at second 0.
+ * Replaces the per-second time tick: the time is read and the hand resynced only twice a minute.
+ * The minute and hour follow the wall time, whichever sync the layout's hand sent.
+ * @param[in] second The second the layout's hand is at
  */
-static void app_time_tick(watch_time_h watch_time, void* user_data)
+static void _minute_sync(int second)
 {
-	_time_get(watch_time);
+	_second_resync();
+}
 
-	if (s_info.second == 60 - (int)MINUTE_PART_ANIMATION_TIME) {
-		view_set_minute(s_info.minute);
+/*
+ * @brief Shows the given time, rolling the minute when it is the next one and setting it directly otherwise
+ * @param[in] hour The hour to show
+ * @param[in] minute The minute to show
+ */
+static void _show_time(int hour, int minute)
+{
+	if (s_info.shown_minute < 0) {
+		view_update_display_time(hour, minute);
+	} else if (minute == (s_info.shown_minute + 1) % 60) {
+		view_set_minute(s_info.shown_minute);
 		view_start_minute_update();
-	} else if (s_info.second == 0 && s_info.minute == 0) {
-		view_set_hour(s_info.hour);
+	} else if (minute != s_info.shown_minute) {
+		view_update_display_time(hour, minute);
 	}
 
-	view_set_second(s_info.second);
+	if (hour != s_info.shown_hour)
+		view_set_hour(hour);
+
+	s_info.shown_hour = hour;
+	s_info.shown_minute = minute;
 }
 
 /*
@@ -238,16 +265,8 @@ static void app_time_tick(watch_time_h watch_time, void* user_data)
  */
 void app_ambient_tick(watch_time_h watch_time, void* user_data)
 {
-	int prev_min = s_info.minute;
 	_time_get(watch_time);
-
-	if (s_info.minute != prev_min) {
-		view_set_minute(s_info.minute - 1);
-		view_start_minute_update();
-
-		if (s_info.minute == 0)
-			view_set_hour(s_info.hour);
-	}
+	_show_time(s_info.hour, s_info.minute);
 }
 
 /*
@@ -259,6 +278,9 @@ static void app_ambient_changed(bool ambient_mode, void* user_data)
 	 * Take necessary actions when application goes to/from ambient state
 	 */
 	view_set_ambient_mode(ambient_mode);
+
+	if (!ambient_mode)
+		_second_resync();
 }
 
 
@@ -276,7 +298,6 @@ int main(int argc, char *argv[])
 	event_callback.pause = app_pause;
 	event_callback.resume = app_resume;
 	event_callback.app_control = app_control;
-	event_callback.time_tick = app_time_tick;
 	event_callback.ambient_tick = app_ambient_tick;
 	event_callback.ambient_changed = app_ambient_changed;
 
@@ -297,17 +318,48 @@ static void _time_get(watch_time_h watch_time)
 	watch_time_get_second(watch_time, &s_info.second);
 	watch_time_get_minute(watch_time, &s_info. minute);
 	watch_time_get_hour(watch_time, &s_info.hour);
+	if (watch_time_get_millisecond(watch_time, &s_info.millisecond) != APP_ERROR_NONE)
+		s_info.millisecond = 0;
 }
 
 /*
  * @brief Reads the current time.
  */
 static void _curent_time_get(void)
+{
+	s_info.shown_minute = -1;
+	s_info.shown_hour = -1;
+	_second_resync();
+}
+
+/*
+ * @brief Puts the second hand on the current second and the next tick on the next wall second,
+ * the layout keeps it moving from there. The minute and hour on screen are brought to the wall time as well,
+ * from MINUTE_SYNC_SECOND on the minute shown is the coming one, the roll animation ends on the full minute.
+ */
+static void _second_resync(void)
 {
 	watch_time_h watch_time;
+	int hour;
+	int minute;
+
+	if (watch_time_get_current_time(&watch_time) != APP_ERROR_NONE) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "failed to get current time.");
+		return;
+	}
 
-	watch_time_get_current_time(&watch_time);
 	_time_get(watch_time);
-	view_update_display_time(s_info.hour, s_info.minute);
 	watch_time_delete(watch_time);
+
+	hour = s_info.hour;
+	minute = s_info.minute;
+	if (s_info.second >= MINUTE_SYNC_SECOND) {
+		minute = (minute + 1) % 60;
+		/* watch_time_get_hour() counts 1 to 12 */
+		if (minute == 0)
+			hour = hour % 12 + 1;
+	}
+
+	_show_time(hour, minute);
+	view_set_second(s_info.second, s_info.millisecond);
 }
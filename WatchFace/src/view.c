@@ -28,6 +28,9 @@ static struct view_info {
 	int w;
 	int h;
 	int minute;
+	view_minute_sync_cb minute_sync_cb;
+	/* "00".."59", built once so part updates never format or allocate */
+	Eina_Stringshare *two_digits[60];
 } s_info = {
 	.win = NULL,
 	.layout = NULL,
@@ -35,6 +38,7 @@ static struct view_info {
 	.w = 0,
 	.h = 0,
 	.minute = 0,
+	.minute_sync_cb = NULL,
 };
 
 static void _message_outside_object_cb(void *data, Evas_Object *obj, Edje_Message_Type type, int id, void *msg);
@@ -60,6 +64,11 @@ void view_create_with_size(int width, int height)
  */
 void view_create(void)
 {
+	int i;
+
+	for (i = 0; i < 60; i++)
+		s_info.two_digits[i] = eina_stringshare_printf("%.2d", i);
+
 	/* Create window */
 	s_info.win = view_create_win(PACKAGE);
 	if (s_info.win == NULL) {
@@ -139,10 +148,17 @@ Evas_Object *view_create_layout_for_part(Evas_Object *parent, char *file_path, c
  */
 void view_destroy(void)
 {
+	int i;
+
 	if (s_info.win == NULL)
 		return;
 
 	evas_object_del(s_info.win);
+
+	for (i = 0; i < 60; i++) {
+		eina_stringshare_del(s_info.two_digits[i]);
+		s_info.two_digits[i] = NULL;
+	}
 }
 
 /*
@@ -164,12 +180,13 @@ void view_set_minute(int minute)
 }
 
 /*
- * @brief Updates the second hand edje part state
+ * @brief Sets the second hand to the given second, the layout keeps it moving from there
  * @param second - Current second
+ * @param millisecond - How far into the current second we are, the first tick waits for the next one
  */
-void view_set_second(int second)
+void view_set_second(int second, int millisecond)
 {
-	Edje_Message_Int msg = {0,};
+	Edje_Message_Int_Set *msg = NULL;
 
 	Evas_Object *edje_obj = elm_layout_edje_get(s_info.layout);
 	if (!edje_obj) {
@@ -177,8 +194,32 @@ void view_set_second(int second)
 		return;
 	}
 
-	msg.val = second;
-	edje_object_message_send(edje_obj, EDJE_MESSAGE_INT, MSG_ID_SECOND_PART, &msg);
+	msg = calloc(1, sizeof(Edje_Message_Int_Set) + sizeof(int));
+	if (!msg)
+		return;
+
+	msg->count = 2;
+	msg->val[0] = second;
+	msg->val[1] = millisecond;
+	edje_object_message_send(edje_obj, EDJE_MESSAGE_INT_SET, MSG_ID_SECOND_PART, msg);
+	free(msg);
+}
+
+/*
+ * @brief Stops the layout's second hand timer until the next view_set_second()
+ */
+void view_stop_second(void)
+{
+	elm_layout_signal_emit(s_info.layout, SIGNAL_SECOND_STOP, "");
+}
+
+/*
+ * @brief Sets the function called when the layout's second hand reaches MINUTE_SYNC_SECOND and 0
+ * @param cb - Callback, receives the second the layout is at
+ */
+void view_set_minute_sync_cb(view_minute_sync_cb cb)
+{
+	s_info.minute_sync_cb = cb;
 }
 
 /*
@@ -228,6 +269,7 @@ void view_reset_display_state(void)
 
 /*
  * @brief Callback invoked when a message from the edje is received. Used to update the value of the last 'minute' part
+ * and to resync the time once a minute
  * @param data - User data
  * @param obj - Edje object which sent the message
  * @param type - The message type
@@ -238,6 +280,12 @@ static void _message_outside_object_cb(void *data, Evas_Object *obj, Edje_Messag
 {
 	Edje_Message_String *edje_msg = NULL;
 
+	if (type == EDJE_MESSAGE_INT && id == MSG_ID_MINUTE_SYNC) {
+		if (s_info.minute_sync_cb)
+			s_info.minute_sync_cb(((Edje_Message_Int *)msg)->val);
+		return;
+	}
+
 	if (type != EDJE_MESSAGE_STRING || id != MSG_ID_MINUTE_PART_NEW_OUTSIDE) {
 		dlog_print(DLOG_ERROR, LOG_TAG, "[%s:%d] Unknown message", __FILE__, __LINE__);
 		return;
@@ -299,7 +347,10 @@ static Evas_Object *_create_layout(void)
  */
 static void _part_text_set(int val, const char *part)
 {
-	Eina_Stringshare *str = eina_stringshare_printf("%.2d", val);
-	elm_layout_text_set(s_info.layout, part, str);
-	eina_stringshare_del(str);
+	if (val < 0 || val >= 60) {
+		dlog_print(DLOG_ERROR, LOG_TAG, "[%s:%d] Value out of range: %d", __FILE__, __LINE__, val);
+		return;
+	}
+
+	elm_layout_text_set(s_info.layout, part, s_info.two_digits[val]);
 }